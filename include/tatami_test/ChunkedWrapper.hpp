@@ -0,0 +1,434 @@
+#ifndef TATAMI_TEST_CHUNKED_WRAPPER_HPP
+#define TATAMI_TEST_CHUNKED_WRAPPER_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @file ChunkedWrapper.hpp
+ * @brief Emulate chunk loading for a chunked matrix.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for the `ChunkedWrapper` constructor.
+ */
+struct ChunkedWrapperOptions {
+    /**
+     * Number of rows in each chunk.
+     */
+    size_t chunk_nrow = 10;
+
+    /**
+     * Number of columns in each chunk.
+     */
+    size_t chunk_ncol = 10;
+
+    /**
+     * Maximum number of chunks that can be held in each extractor's cache.
+     * If this is positive but less than the number of chunks in a slab, the cache will still hold a single slab,
+     * consistent with the minimum cache size in **tatami_chunked**'s slab caches.
+     */
+    size_t cache_size = 100;
+};
+
+/**
+ * @brief Chunk cache statistics from a `ChunkedWrapper`.
+ */
+struct ChunkedWrapperStatistics {
+    /**
+     * Number of chunks that were loaded into the cache.
+     */
+    size_t loads = 0;
+
+    /**
+     * Number of times that a required chunk was already present in the cache.
+     */
+    size_t hits = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+struct ChunkedCounter {
+    std::atomic<size_t> loads{0};
+    std::atomic<size_t> hits{0};
+};
+
+template<typename Index_>
+Index_ chunked_count_secondary(Index_ start, Index_ length, Index_ chunk_size) {
+    if (length == 0) {
+        return 0;
+    }
+    return (start + length - 1) / chunk_size - start / chunk_size + 1;
+}
+
+template<typename Index_>
+Index_ chunked_count_secondary(const std::vector<Index_>& indices, Index_ chunk_size) {
+    Index_ count = 0;
+    bool first = true;
+    Index_ last = 0;
+    for (auto i : indices) {
+        Index_ current = i / chunk_size;
+        if (first || current != last) {
+            ++count;
+            first = false;
+            last = current;
+        }
+    }
+    return count;
+}
+
+// Each cache element is a "slab" of all chunks along the non-target dimension for a single chunk along the target dimension.
+// This is equivalent to the behavior of the slab caches in tatami_chunked.
+template<bool oracle_, typename Index_>
+class ChunkedSlabCache {
+public:
+    ChunkedSlabCache(tatami::MaybeOracle<oracle_, Index_> oracle, Index_ target_chunk, size_t chunks_per_slab, size_t cache_size, ChunkedCounter& counter) :
+        my_oracle(std::move(oracle)),
+        my_target_chunk(target_chunk),
+        my_chunks_per_slab(chunks_per_slab),
+        my_max_slabs(chunks_per_slab && cache_size ? std::max(static_cast<size_t>(1), cache_size / chunks_per_slab) : 0),
+        my_counter(counter)
+    {}
+
+private:
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    size_t my_used = 0;
+    Index_ my_target_chunk;
+    size_t my_chunks_per_slab;
+    size_t my_max_slabs;
+    ChunkedCounter& my_counter;
+
+    // For myopic extraction, we use an LRU cache.
+    std::list<Index_> my_lru;
+    std::unordered_map<Index_, typename std::list<Index_>::iterator> my_lru_map;
+
+    // For oracular extraction, we load all slabs required for the next batch of predictions.
+    std::vector<Index_> my_batch, my_next_batch;
+
+    void load(size_t nslabs) {
+        my_counter.loads += my_chunks_per_slab * nslabs;
+    }
+
+    void hit() {
+        my_counter.hits += my_chunks_per_slab;
+    }
+
+    void fetch_myopic(Index_ slab) {
+        auto it = my_lru_map.find(slab);
+        if (it != my_lru_map.end()) {
+            hit();
+            my_lru.splice(my_lru.begin(), my_lru, it->second);
+            return;
+        }
+
+        load(1);
+        if (my_max_slabs == 0) {
+            return;
+        }
+        if (my_lru.size() == my_max_slabs) {
+            my_lru_map.erase(my_lru.back());
+            my_lru.pop_back();
+        }
+        my_lru.push_front(slab);
+        my_lru_map[slab] = my_lru.begin();
+    }
+
+    void fetch_oracular(Index_ slab) {
+        if (std::find(my_batch.begin(), my_batch.end(), slab) != my_batch.end()) {
+            hit();
+            return;
+        }
+
+        if (my_max_slabs == 0) {
+            load(1);
+            return;
+        }
+
+        // Walking through the predictions to fill the cache, always including the current slab.
+        my_next_batch.clear();
+        my_next_batch.push_back(slab);
+        for (size_t p = my_used, total = my_oracle->total(); p < total; ++p) {
+            Index_ next = my_oracle->get(p) / my_target_chunk;
+            if (std::find(my_next_batch.begin(), my_next_batch.end(), next) != my_next_batch.end()) {
+                continue;
+            }
+            if (my_next_batch.size() >= my_max_slabs) {
+                break;
+            }
+            my_next_batch.push_back(next);
+        }
+
+        // Slabs that were already in the previous batch don't need to be reloaded.
+        size_t nloaded = 0;
+        for (auto s : my_next_batch) {
+            if (std::find(my_batch.begin(), my_batch.end(), s) == my_batch.end()) {
+                ++nloaded;
+            }
+        }
+        load(nloaded);
+        my_batch.swap(my_next_batch);
+    }
+
+public:
+    void fetch(Index_ i) {
+        if constexpr(oracle_) {
+            i = my_oracle->get(my_used++);
+            fetch_oracular(i / my_target_chunk);
+        } else {
+            fetch_myopic(i / my_target_chunk);
+        }
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class ChunkedDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    ChunkedDenseExtractor(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host, ChunkedSlabCache<oracle_, Index_> cache) :
+        my_host(std::move(host)), my_cache(std::move(cache)) {}
+
+private:
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > my_host;
+    ChunkedSlabCache<oracle_, Index_> my_cache;
+
+public:
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        my_cache.fetch(i);
+        return my_host->fetch(i, buffer);
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class ChunkedSparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    ChunkedSparseExtractor(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host, ChunkedSlabCache<oracle_, Index_> cache) :
+        my_host(std::move(host)), my_cache(std::move(cache)) {}
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > my_host;
+    ChunkedSlabCache<oracle_, Index_> my_cache;
+
+public:
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        my_cache.fetch(i);
+        return my_host->fetch(i, vbuffer, ibuffer);
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Emulate chunk loading for a chunked matrix.
+ * @tparam Value_ Type of matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * This wrapper emulates a matrix that is stored in chunks on disk, e.g., in HDF5 or Zarr formats, where the cost of access is dominated by the number of chunks that need to be loaded.
+ * Each extractor has its own cache of chunks, where the chunks overlapping the non-target selection for a single target chunk are loaded together as a "slab".
+ * For myopic extraction, the cache uses a least-recently-used eviction policy.
+ * For oracular extraction, the cache is filled with all slabs required for the upcoming predictions, and slabs are retained if they are required for the next batch.
+ * The actual values are obtained from the wrapped matrix.
+ *
+ * The number of chunk loads is counted deterministically, without any dependence on timing.
+ * This allows us to check the efficiency of access patterns in delayed operations that use a chunked matrix as a seed,
+ * e.g., by asserting an upper bound on the number of chunk loads for oracular and myopic access with the various `TestAccessOrder` choices.
+ */
+template<typename Value_, typename Index_>
+class ChunkedWrapper final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param matrix Pointer to a `tatami::Matrix` containing the matrix values.
+     * @param options Further options.
+     */
+    ChunkedWrapper(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, const ChunkedWrapperOptions& options) :
+        my_matrix(std::move(matrix)),
+        my_chunk_nrow(std::max(options.chunk_nrow, static_cast<size_t>(1))),
+        my_chunk_ncol(std::max(options.chunk_ncol, static_cast<size_t>(1))),
+        my_cache_size(options.cache_size)
+    {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    Index_ my_chunk_nrow, my_chunk_ncol;
+    size_t my_cache_size;
+    mutable std::array<internal::ChunkedCounter, 2> my_counters;
+
+public:
+    /**
+     * @param oracle Whether to report statistics for oracular extraction.
+     * If false, statistics are reported for myopic extraction.
+     * @return Chunk cache statistics for the specified type of extraction, summed across all extractors.
+     */
+    ChunkedWrapperStatistics statistics(bool oracle) const {
+        const auto& current = my_counters[oracle];
+        ChunkedWrapperStatistics output;
+        output.loads = current.loads.load();
+        output.hits = current.hits.load();
+        return output;
+    }
+
+    /**
+     * @return Chunk cache statistics for all extractors.
+     */
+    ChunkedWrapperStatistics statistics() const {
+        auto output = statistics(false);
+        auto other = statistics(true);
+        output.loads += other.loads;
+        output.hits += other.hits;
+        return output;
+    }
+
+    /**
+     * Reset all statistics to zero.
+     */
+    void reset() {
+        for (auto& current : my_counters) {
+            current.loads = 0;
+            current.hits = 0;
+        }
+    }
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    /**
+     * @param row Whether to extract rows.
+     * @return Whether the extractors make use of an oracle.
+     * If `ChunkedWrapperOptions::cache_size` is positive, this is always true as the oracle is used to decide which slabs to retain in the cache.
+     * Otherwise, no caching is performed and this is forwarded from the wrapped matrix.
+     */
+    bool uses_oracle(bool row) const {
+        if (my_cache_size == 0) {
+            return my_matrix->uses_oracle(row);
+        }
+        return true;
+    }
+
+private:
+    template<bool oracle_>
+    internal::ChunkedSlabCache<oracle_, Index_> create_cache(bool row, tatami::MaybeOracle<oracle_, Index_> ora, Index_ chunks_per_slab) const {
+        return internal::ChunkedSlabCache<oracle_, Index_>(std::move(ora), (row ? my_chunk_nrow : my_chunk_ncol), chunks_per_slab, my_cache_size, my_counters[oracle_]);
+    }
+
+    Index_ secondary_chunk(bool row) const {
+        return (row ? my_chunk_ncol : my_chunk_nrow);
+    }
+
+    Index_ full_chunks(bool row) const {
+        return internal::chunked_count_secondary<Index_>(0, (row ? my_matrix->ncol() : my_matrix->nrow()), secondary_chunk(row));
+    }
+
+    Index_ block_chunks(bool row, Index_ bs, Index_ bl) const {
+        return internal::chunked_count_secondary<Index_>(bs, bl, secondary_chunk(row));
+    }
+
+    Index_ index_chunks(bool row, const tatami::VectorPtr<Index_>& idx) const {
+        return internal::chunked_count_secondary<Index_>(*idx, secondary_chunk(row));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > wrap_dense(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host, bool row, tatami::MaybeOracle<oracle_, Index_> ora, Index_ nchunks) const {
+        return std::make_unique<internal::ChunkedDenseExtractor<oracle_, Value_, Index_> >(std::move(host), create_cache<oracle_>(row, std::move(ora), nchunks));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > wrap_sparse(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host, bool row, tatami::MaybeOracle<oracle_, Index_> ora, Index_ nchunks) const {
+        return std::make_unique<internal::ChunkedSparseExtractor<oracle_, Value_, Index_> >(std::move(host), create_cache<oracle_>(row, std::move(ora), nchunks));
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, opt), row, false, full_chunks(row));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, bs, bl, opt), row, false, block_chunks(row, bs, bl));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        auto nchunks = index_chunks(row, idx);
+        return wrap_dense<false>(my_matrix->dense(row, std::move(idx), opt), row, false, nchunks);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, opt), row, false, full_chunks(row));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, bs, bl, opt), row, false, block_chunks(row, bs, bl));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        auto nchunks = index_chunks(row, idx);
+        return wrap_sparse<false>(my_matrix->sparse(row, std::move(idx), opt), row, false, nchunks);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, ora, opt), row, ora, full_chunks(row));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, ora, bs, bl, opt), row, ora, block_chunks(row, bs, bl));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        auto nchunks = index_chunks(row, idx);
+        return wrap_dense<true>(my_matrix->dense(row, ora, std::move(idx), opt), row, ora, nchunks);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, opt), row, ora, full_chunks(row));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, bs, bl, opt), row, ora, block_chunks(row, bs, bl));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        auto nchunks = index_chunks(row, idx);
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, std::move(idx), opt), row, ora, nchunks);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef TATAMI_TEST_COUNTING_WRAPPER_HPP
+#define TATAMI_TEST_COUNTING_WRAPPER_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @file CountingWrapper.hpp
+ * @brief Count extractors, fetches and returned elements.
+ */
+
+namespace tatami_test {
+
+/**
+ * Type of selection on the non-target dimension during extraction.
+ *
+ * - `FULL`: the full extent of the non-target dimension.
+ * - `BLOCK`: a contiguous block of the non-target dimension.
+ * - `INDEX`: an indexed subset of the non-target dimension.
+ */
+enum class CountingSelection : char { FULL, BLOCK, INDEX };
+
+/**
+ * @brief Counts from a `CountingWrapper`.
+ */
+struct CountingStatistics {
+    /**
+     * Number of extractors that were created.
+     */
+    size_t extractors = 0;
+
+    /**
+     * Number of calls to `fetch()` across all extractors.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Number of elements returned by all `fetch()` calls.
+     * For dense extractors, this is the number of elements in the selection on the non-target dimension for each call.
+     * For sparse extractors, this is the number of structural non-zeros returned by each call.
+     */
+    size_t elements = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+struct CountingCounter {
+    std::atomic<size_t> extractors{0};
+    std::atomic<size_t> fetches{0};
+    std::atomic<size_t> elements{0};
+};
+
+template<bool oracle_, typename Index_>
+class CountingTarget {
+public:
+    CountingTarget(tatami::MaybeOracle<oracle_, Index_> oracle) : my_oracle(std::move(oracle)) {}
+
+private:
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    size_t my_used = 0;
+
+public:
+    Index_ next(Index_ i) {
+        if constexpr(oracle_) {
+            return my_oracle->get(my_used++);
+        } else {
+            return i;
+        }
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class CountingDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    CountingDenseExtractor(
+        std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        Index_ number,
+        CountingCounter& counter,
+        std::vector<std::atomic<size_t> >& per_index) :
+        my_host(std::move(host)), my_target(std::move(oracle)), my_number(number), my_counter(counter), my_per_index(per_index)
+    {
+        ++(my_counter.extractors);
+    }
+
+private:
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > my_host;
+    CountingTarget<oracle_, Index_> my_target;
+    Index_ my_number;
+    CountingCounter& my_counter;
+    std::vector<std::atomic<size_t> >& my_per_index;
+
+public:
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        ++(my_per_index[my_target.next(i)]);
+        ++(my_counter.fetches);
+        my_counter.elements += my_number;
+        return my_host->fetch(i, buffer);
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class CountingSparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    CountingSparseExtractor(
+        std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        CountingCounter& counter,
+        std::vector<std::atomic<size_t> >& per_index) :
+        my_host(std::move(host)), my_target(std::move(oracle)), my_counter(counter), my_per_index(per_index)
+    {
+        ++(my_counter.extractors);
+    }
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > my_host;
+    CountingTarget<oracle_, Index_> my_target;
+    CountingCounter& my_counter;
+    std::vector<std::atomic<size_t> >& my_per_index;
+
+public:
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        ++(my_per_index[my_target.next(i)]);
+        auto range = my_host->fetch(i, vbuffer, ibuffer);
+        ++(my_counter.fetches);
+        my_counter.elements += range.number;
+        return range;
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Count extractors, fetches and returned elements.
+ * @tparam Value_ Type of matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * This wrapper records the number of extractors that were created, the number of `fetch()` calls and the number of returned elements.
+ * Counts are reported separately for dense/sparse, oracular/myopic and full/block/indexed extraction.
+ * It also records the number of times that each row/column was fetched.
+ * The aim is to enable testing of `tatami::Matrix` subclasses that implement delayed operations on an existing "seed" matrix,
+ * e.g., to check that a delayed operation does not fetch the same row of the seed multiple times, or that it does not extract the full row when only a block is required.
+ * Such checks are most relevant when the seed is expensive to access, e.g., because it is backed by a file.
+ *
+ * All counters are atomic so the wrapper can be used in multi-threaded tests.
+ */
+template<typename Value_, typename Index_>
+class CountingWrapper final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param matrix Pointer to a `tatami::Matrix`.
+     * This is typically the seed matrix that would otherwise be directly used in a delayed operation.
+     */
+    CountingWrapper(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix) :
+        my_matrix(std::move(matrix)),
+        my_row_fetches(my_matrix->nrow()),
+        my_column_fetches(my_matrix->ncol())
+    {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    mutable std::array<internal::CountingCounter, 12> my_counters;
+    mutable std::vector<std::atomic<size_t> > my_row_fetches, my_column_fetches;
+
+    static size_t counter_position(bool sparse, bool oracle, CountingSelection selection) {
+        return static_cast<size_t>(sparse) * 6 + static_cast<size_t>(oracle) * 3 + static_cast<size_t>(selection);
+    }
+
+    internal::CountingCounter& counter(bool sparse, bool oracle, CountingSelection selection) const {
+        return my_counters[counter_position(sparse, oracle, selection)];
+    }
+
+    std::vector<std::atomic<size_t> >& per_index(bool row) const {
+        return (row ? my_row_fetches : my_column_fetches);
+    }
+
+public:
+    /**
+     * @param sparse Whether to report counts for sparse extraction.
+     * @param oracle Whether to report counts for oracular extraction.
+     * @param selection Type of selection on the non-target dimension.
+     * @return Counts for the specified type of extraction.
+     */
+    CountingStatistics statistics(bool sparse, bool oracle, CountingSelection selection) const {
+        const auto& current = counter(sparse, oracle, selection);
+        CountingStatistics output;
+        output.extractors = current.extractors.load();
+        output.fetches = current.fetches.load();
+        output.elements = current.elements.load();
+        return output;
+    }
+
+    /**
+     * @return Counts for all types of extraction.
+     */
+    CountingStatistics statistics() const {
+        CountingStatistics output;
+        for (const auto& current : my_counters) {
+            output.extractors += current.extractors.load();
+            output.fetches += current.fetches.load();
+            output.elements += current.elements.load();
+        }
+        return output;
+    }
+
+    /**
+     * @param row Whether to report counts for rows.
+     * If false, counts are reported for columns.
+     * @return Vector of length equal to the number of rows (or columns), containing the number of times that each row (column) was fetched across all extractors.
+     */
+    std::vector<size_t> fetches_per_index(bool row) const {
+        const auto& source = per_index(row);
+        std::vector<size_t> output;
+        output.reserve(source.size());
+        for (const auto& x : source) {
+            output.push_back(x.load());
+        }
+        return output;
+    }
+
+    /**
+     * Reset all counts to zero.
+     */
+    void reset() {
+        for (auto& current : my_counters) {
+            current.extractors = 0;
+            current.fetches = 0;
+            current.elements = 0;
+        }
+        for (auto& x : my_row_fetches) {
+            x = 0;
+        }
+        for (auto& x : my_column_fetches) {
+            x = 0;
+        }
+    }
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return my_matrix->uses_oracle(row);
+    }
+
+private:
+    Index_ secondary(bool row) const {
+        return (row ? my_matrix->ncol() : my_matrix->nrow());
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > wrap_dense(
+        std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host,
+        bool row,
+        tatami::MaybeOracle<oracle_, Index_> ora,
+        Index_ number,
+        CountingSelection selection)
+    const {
+        return std::make_unique<internal::CountingDenseExtractor<oracle_, Value_, Index_> >(std::move(host), std::move(ora), number, counter(false, oracle_, selection), per_index(row));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > wrap_sparse(
+        std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host,
+        bool row,
+        tatami::MaybeOracle<oracle_, Index_> ora,
+        CountingSelection selection)
+    const {
+        return std::make_unique<internal::CountingSparseExtractor<oracle_, Value_, Index_> >(std::move(host), std::move(ora), counter(true, oracle_, selection), per_index(row));
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, opt), row, false, secondary(row), CountingSelection::FULL);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, bs, bl, opt), row, false, bl, CountingSelection::BLOCK);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        Index_ number = idx->size();
+        return wrap_dense<false>(my_matrix->dense(row, std::move(idx), opt), row, false, number, CountingSelection::INDEX);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, opt), row, false, CountingSelection::FULL);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, bs, bl, opt), row, false, CountingSelection::BLOCK);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, std::move(idx), opt), row, false, CountingSelection::INDEX);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, ora, opt), row, ora, secondary(row), CountingSelection::FULL);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, ora, bs, bl, opt), row, ora, bl, CountingSelection::BLOCK);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        Index_ number = idx->size();
+        return wrap_dense<true>(my_matrix->dense(row, ora, std::move(idx), opt), row, ora, number, CountingSelection::INDEX);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, opt), row, ora, CountingSelection::FULL);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, bs, bl, opt), row, ora, CountingSelection::BLOCK);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, ora, std::move(idx), opt), row, ora, CountingSelection::INDEX);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef TATAMI_TEST_GUARDED_BUFFER_HPP
+#define TATAMI_TEST_GUARDED_BUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define TATAMI_TEST_HAS_GUARD_PAGES
+#endif
+
+/**
+ * @file GuardedBuffer.hpp
+ * @brief Output buffer with guard pages to catch out-of-bounds writes.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Output buffer with guard pages to catch out-of-bounds writes.
+ * @tparam Type_ Type of the buffer elements.
+ *
+ * This allocates a buffer with `mmap()` and surrounds it with inaccessible guard pages.
+ * The last valid element is placed immediately before the trailing guard page, so any write past the end of the buffer causes a segmentation fault.
+ * The leading guard page catches writes that start before the buffer's page,
+ * while writes into the remainder of the first page (i.e., between the leading guard page and the first valid element) are detected by a canary pattern, see `intact()`.
+ * This provides some protection against buffer overruns in `fetch()` without the run-time cost of AddressSanitizer.
+ *
+ * On platforms without `mmap()`, the buffer is surrounded by canaries only, so overruns are only detected after the fact by `intact()`.
+ */
+template<typename Type_>
+class GuardedBuffer {
+public:
+    /**
+     * @param n Number of elements in the buffer.
+     */
+    GuardedBuffer(size_t n) : my_size(n) {
+        size_t nbytes = n * sizeof(Type_);
+
+#ifdef TATAMI_TEST_HAS_GUARD_PAGES
+        my_page = sysconf(_SC_PAGESIZE);
+        size_t data_pages = (nbytes + my_page - 1) / my_page;
+        my_mapped = (data_pages + 2) * my_page;
+        void* base = mmap(NULL, my_mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("failed to map memory for a guarded buffer");
+        }
+        my_base = static_cast<unsigned char*>(base);
+
+        unsigned char* rear = my_base + my_page + data_pages * my_page;
+        if (mprotect(my_base, my_page, PROT_NONE) != 0 || mprotect(rear, my_page, PROT_NONE) != 0) {
+            munmap(my_base, my_mapped);
+            throw std::runtime_error("failed to protect the guard pages of a guarded buffer");
+        }
+
+        my_front = my_base + my_page;
+        my_data = rear - nbytes;
+        my_back = rear;
+#else
+        my_storage.resize(nbytes + 2 * fallback_canary);
+        my_front = my_storage.data();
+        my_data = my_front + fallback_canary;
+        my_back = my_storage.data() + my_storage.size();
+#endif
+
+        std::memset(my_front, canary, my_data - my_front);
+        std::memset(my_data + nbytes, canary, my_back - my_data - nbytes);
+    }
+
+    /**
+     * @cond
+     */
+    GuardedBuffer(const GuardedBuffer&) = delete;
+    GuardedBuffer& operator=(const GuardedBuffer&) = delete;
+
+    GuardedBuffer(GuardedBuffer&& other) {
+        *this = std::move(other);
+    }
+
+    GuardedBuffer& operator=(GuardedBuffer&& other) {
+        if (this != &other) {
+            release();
+            my_size = other.my_size;
+            my_front = other.my_front;
+            my_data = other.my_data;
+            my_back = other.my_back;
+#ifdef TATAMI_TEST_HAS_GUARD_PAGES
+            my_base = other.my_base;
+            my_page = other.my_page;
+            my_mapped = other.my_mapped;
+            other.my_base = NULL;
+#else
+            my_storage = std::move(other.my_storage);
+#endif
+            other.my_size = 0;
+            other.my_front = NULL;
+            other.my_data = NULL;
+            other.my_back = NULL;
+        }
+        return *this;
+    }
+
+    ~GuardedBuffer() {
+        release();
+    }
+    /**
+     * @endcond
+     */
+
+private:
+    size_t my_size = 0;
+    unsigned char* my_front = NULL;
+    unsigned char* my_data = NULL;
+    unsigned char* my_back = NULL;
+
+    static constexpr unsigned char canary = 0xA5;
+
+#ifdef TATAMI_TEST_HAS_GUARD_PAGES
+    unsigned char* my_base = NULL;
+    size_t my_page = 0;
+    size_t my_mapped = 0;
+#else
+    static constexpr size_t fallback_canary = 64;
+    std::vector<unsigned char> my_storage;
+#endif
+
+    void release() {
+#ifdef TATAMI_TEST_HAS_GUARD_PAGES
+        if (my_base) {
+            munmap(my_base, my_mapped);
+            my_base = NULL;
+        }
+#endif
+    }
+
+public:
+    /**
+     * @return Pointer to the start of the buffer.
+     * The last element of the buffer is immediately followed by an inaccessible page.
+     */
+    Type_* data() {
+        return reinterpret_cast<Type_*>(my_data);
+    }
+
+    /**
+     * @return Pointer to the start of the buffer.
+     */
+    const Type_* data() const {
+        return reinterpret_cast<const Type_*>(my_data);
+    }
+
+    /**
+     * @return Number of elements in the buffer.
+     */
+    size_t size() const {
+        return my_size;
+    }
+
+    /**
+     * Check whether the canaries around the buffer are intact.
+     * This detects writes before the start of the buffer that did not reach the leading guard page.
+     * On platforms without `mmap()`, it also detects writes past the end of the buffer.
+     *
+     * @return Whether the canaries are intact.
+     */
+    bool intact() const {
+        const unsigned char* end = my_data + my_size * sizeof(Type_);
+        for (const unsigned char* ptr = my_front; ptr < my_data; ++ptr) {
+            if (*ptr != canary) {
+                return false;
+            }
+        }
+        for (const unsigned char* ptr = end; ptr < my_back; ++ptr) {
+            if (*ptr != canary) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @return Whether `GuardedBuffer` uses guard pages on this platform.
+ * If `false`, `GuardedBuffer` only uses canaries.
+ */
+inline constexpr bool guard_pages_supported() {
+#ifdef TATAMI_TEST_HAS_GUARD_PAGES
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef TATAMI_TEST_LATENCY_WRAPPER_HPP
+#define TATAMI_TEST_LATENCY_WRAPPER_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file LatencyWrapper.hpp
+ * @brief Add latency to each fetch.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for the `LatencyWrapper` constructor.
+ */
+struct LatencyWrapperOptions {
+    /**
+     * Latency added to each call to `fetch()`, in nanoseconds.
+     */
+    double per_fetch = 0;
+
+    /**
+     * Latency added for each element returned by `fetch()`, in nanoseconds.
+     * For dense extractors, the number of elements is the size of the selection on the non-target dimension.
+     * For sparse extractors, the number of elements is the number of structural non-zeros.
+     */
+    double per_element = 0;
+
+    /**
+     * Relative jitter in the latency, should lie in `[0, 1]`.
+     * The latency for each call is multiplied by a factor that is sampled uniformly from `[1 - jitter, 1 + jitter]`.
+     */
+    double jitter = 0;
+
+    /**
+     * Seed for the PRNG used to sample the jitter.
+     */
+    uint64_t seed = 1234567890;
+
+    /**
+     * Number of predictions that are "loaded" together during oracular extraction.
+     * For oracular extractors, `LatencyWrapperOptions::per_fetch` is only incurred on every `oracle_batch`-th call to `fetch()`,
+     * mimicking a disk-backed matrix that reads multiple predicted rows/columns in a single operation.
+     * If this is greater than 1, `tatami::Matrix::uses_oracle()` will always return true.
+     */
+    size_t oracle_batch = 1;
+
+    /**
+     * Whether to busy-wait instead of sleeping.
+     * This is more accurate for small latencies but consumes CPU time.
+     */
+    bool busy_wait = false;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+class LatencyInjector {
+public:
+    LatencyInjector(const LatencyWrapperOptions& options, uint64_t seed, bool oracle) :
+        my_options(options), my_rng(seed), my_batch(oracle ? std::max(options.oracle_batch, static_cast<size_t>(1)) : 1) {}
+
+private:
+    const LatencyWrapperOptions& my_options;
+    std::mt19937_64 my_rng;
+    size_t my_batch;
+    size_t my_counter = 0;
+
+public:
+    void wait(size_t elements) {
+        double delay = my_options.per_element * elements;
+        if (my_counter % my_batch == 0) {
+            delay += my_options.per_fetch;
+        }
+        ++my_counter;
+
+        if (my_options.jitter > 0) {
+            std::uniform_real_distribution<> unif(1 - my_options.jitter, 1 + my_options.jitter);
+            delay *= unif(my_rng);
+        }
+        if (delay <= 0) {
+            return;
+        }
+
+        std::chrono::nanoseconds duration(static_cast<int64_t>(delay));
+        if (my_options.busy_wait) {
+            auto deadline = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < deadline) {}
+        } else {
+            std::this_thread::sleep_for(duration);
+        }
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class LatencyDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    LatencyDenseExtractor(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host, Index_ number, const LatencyWrapperOptions& options, uint64_t seed) :
+        my_host(std::move(host)), my_number(number), my_injector(options, seed, oracle_) {}
+
+private:
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > my_host;
+    Index_ my_number;
+    LatencyInjector my_injector;
+
+public:
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        auto output = my_host->fetch(i, buffer);
+        my_injector.wait(my_number);
+        return output;
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class LatencySparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    LatencySparseExtractor(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host, const LatencyWrapperOptions& options, uint64_t seed) :
+        my_host(std::move(host)), my_injector(options, seed, oracle_) {}
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > my_host;
+    LatencyInjector my_injector;
+
+public:
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        auto range = my_host->fetch(i, vbuffer, ibuffer);
+        my_injector.wait(range.number);
+        return range;
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Add latency to each fetch.
+ * @tparam Value_ Type of matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * This wrapper adds a configurable delay to each `fetch()` call, emulating a seed matrix that is expensive to access, e.g., because it is backed by a file.
+ * The aim is to enable benchmarking of `tatami::Matrix` subclasses that implement delayed operations on an existing "seed" matrix,
+ * where we may wish to check that the delayed operation uses an oracle to hide the latency of the seed.
+ * Setting `LatencyWrapperOptions::oracle_batch` greater than 1 ensures that oracular extraction is cheaper than myopic extraction,
+ * so any regressions where the delayed operation falls back to myopic extraction will manifest as a slowdown.
+ */
+template<typename Value_, typename Index_>
+class LatencyWrapper final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param matrix Pointer to a `tatami::Matrix`.
+     * This is typically the seed matrix that would otherwise be directly used in a delayed operation.
+     * @param options Further options.
+     */
+    LatencyWrapper(std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix, LatencyWrapperOptions options) :
+        my_matrix(std::move(matrix)), my_options(std::move(options)) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_matrix;
+    LatencyWrapperOptions my_options;
+    mutable std::atomic<uint64_t> my_extractor_counter{0};
+
+    uint64_t next_seed() const {
+        // Each extractor gets a different stream for its jitter.
+        return my_options.seed + 1000003 * (my_extractor_counter++);
+    }
+
+    Index_ secondary(bool row) const {
+        return (row ? my_matrix->ncol() : my_matrix->nrow());
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > wrap_dense(std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > host, Index_ number) const {
+        return std::make_unique<internal::LatencyDenseExtractor<oracle_, Value_, Index_> >(std::move(host), number, my_options, next_seed());
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > wrap_sparse(std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > host) const {
+        return std::make_unique<internal::LatencySparseExtractor<oracle_, Value_, Index_> >(std::move(host), my_options, next_seed());
+    }
+
+public:
+    Index_ nrow() const {
+        return my_matrix->nrow();
+    }
+
+    Index_ ncol() const {
+        return my_matrix->ncol();
+    }
+
+    bool is_sparse() const {
+        return my_matrix->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_matrix->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_matrix->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_matrix->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(bool row) const {
+        return my_options.oracle_batch > 1 || my_matrix->uses_oracle(row);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, opt), secondary(row));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<false>(my_matrix->dense(row, bs, bl, opt), bl);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        Index_ number = idx->size();
+        return wrap_dense<false>(my_matrix->dense(row, std::move(idx), opt), number);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, opt));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, bs, bl, opt));
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return wrap_sparse<false>(my_matrix->sparse(row, std::move(idx), opt));
+    }
+
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, std::move(ora), opt), secondary(row));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_dense<true>(my_matrix->dense(row, std::move(ora), bs, bl, opt), bl);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        Index_ number = idx->size();
+        return wrap_dense<true>(my_matrix->dense(row, std::move(ora), std::move(idx), opt), number);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, std::move(ora), opt));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, std::move(ora), bs, bl, opt));
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return wrap_sparse<true>(my_matrix->sparse(row, std::move(ora), std::move(idx), opt));
+    }
+};
+
+}
+
+#endif
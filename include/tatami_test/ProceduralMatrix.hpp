@@ -0,0 +1,340 @@
+#ifndef TATAMI_TEST_PROCEDURAL_MATRIX_HPP
+#define TATAMI_TEST_PROCEDURAL_MATRIX_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @file ProceduralMatrix.hpp
+ * @brief Procedurally generated matrix.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for the `ProceduralMatrix` constructor.
+ */
+struct ProceduralMatrixOptions {
+    /**
+     * Lower bound on the simulated values.
+     */
+    double lower = 0;
+
+    /**
+     * Upper bound on the simulated values.
+     */
+    double upper = 100;
+
+    /**
+     * Density of non-zero values for the simulated values.
+     */
+    double density = 0.1;
+
+    /**
+     * Seed for the hash.
+     */
+    uint64_t seed = 1234567890;
+
+    /**
+     * Whether the matrix should report that it prefers row access in `tatami::Matrix::prefer_rows()`.
+     */
+    bool prefer_rows = true;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline uint64_t procedural_mix(uint64_t z) {
+    // SplitMix64 finalizer.
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline double procedural_uniform(uint64_t h) {
+    return static_cast<double>(h >> 11) * 0x1.0p-53;
+}
+
+template<typename Value_>
+class ProceduralGenerator {
+public:
+    ProceduralGenerator(const ProceduralMatrixOptions& options) :
+        my_lower(options.lower), my_range(options.upper - options.lower), my_density(options.density), my_seed(options.seed) {}
+
+private:
+    double my_lower, my_range, my_density;
+    uint64_t my_seed;
+
+public:
+    // Computes the value at (r, c), returning false if it is a structural zero.
+    bool get(uint64_t r, uint64_t c, Value_& value) const {
+        uint64_t h = procedural_mix(my_seed + 0x9E3779B97F4A7C15ull * (r + 1));
+        h = procedural_mix(h ^ (0xD1B54A32D192ED03ull * (c + 1)));
+        if (procedural_uniform(h) >= my_density) {
+            return false;
+        }
+        value = my_lower + my_range * procedural_uniform(procedural_mix(h));
+        return true;
+    }
+
+    bool is_sparse() const {
+        return my_density < 1;
+    }
+};
+
+template<typename Index_>
+class ProceduralSelection {
+public:
+    ProceduralSelection(Index_ start, Index_ length) : my_start(start), my_length(length) {}
+
+    ProceduralSelection(tatami::VectorPtr<Index_> indices) : my_length(indices->size()), my_indices(std::move(indices)) {}
+
+private:
+    Index_ my_start = 0, my_length;
+    tatami::VectorPtr<Index_> my_indices;
+
+public:
+    Index_ size() const {
+        return my_length;
+    }
+
+    Index_ operator[](Index_ i) const {
+        if (my_indices) {
+            return (*my_indices)[i];
+        } else {
+            return my_start + i;
+        }
+    }
+};
+
+template<bool oracle_, typename Index_>
+class ProceduralTarget {
+public:
+    ProceduralTarget(tatami::MaybeOracle<oracle_, Index_> oracle) : my_oracle(std::move(oracle)) {}
+
+private:
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    size_t my_used = 0;
+
+public:
+    Index_ next(Index_ i) {
+        if constexpr(oracle_) {
+            return my_oracle->get(my_used++);
+        } else {
+            return i;
+        }
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class ProceduralDenseExtractor final : public tatami::DenseExtractor<oracle_, Value_, Index_> {
+public:
+    ProceduralDenseExtractor(const ProceduralGenerator<Value_>& generator, bool row, tatami::MaybeOracle<oracle_, Index_> oracle, ProceduralSelection<Index_> selection) :
+        my_generator(generator), my_row(row), my_target(std::move(oracle)), my_selection(std::move(selection)) {}
+
+private:
+    const ProceduralGenerator<Value_>& my_generator;
+    bool my_row;
+    ProceduralTarget<oracle_, Index_> my_target;
+    ProceduralSelection<Index_> my_selection;
+
+public:
+    const Value_* fetch(Index_ i, Value_* buffer) {
+        i = my_target.next(i);
+        for (Index_ s = 0, end = my_selection.size(); s < end; ++s) {
+            auto other = my_selection[s];
+            Value_ val = 0;
+            if (my_row) {
+                my_generator.get(i, other, val);
+            } else {
+                my_generator.get(other, i, val);
+            }
+            buffer[s] = val;
+        }
+        return buffer;
+    }
+};
+
+template<bool oracle_, typename Value_, typename Index_>
+class ProceduralSparseExtractor final : public tatami::SparseExtractor<oracle_, Value_, Index_> {
+public:
+    ProceduralSparseExtractor(const ProceduralGenerator<Value_>& generator, bool row, tatami::MaybeOracle<oracle_, Index_> oracle, ProceduralSelection<Index_> selection, const tatami::Options& opt) :
+        my_generator(generator),
+        my_row(row),
+        my_target(std::move(oracle)),
+        my_selection(std::move(selection)),
+        my_needs_value(opt.sparse_extract_value),
+        my_needs_index(opt.sparse_extract_index)
+    {}
+
+private:
+    const ProceduralGenerator<Value_>& my_generator;
+    bool my_row;
+    ProceduralTarget<oracle_, Index_> my_target;
+    ProceduralSelection<Index_> my_selection;
+    bool my_needs_value, my_needs_index;
+
+public:
+    tatami::SparseRange<Value_, Index_> fetch(Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        i = my_target.next(i);
+        Index_ count = 0;
+        for (Index_ s = 0, end = my_selection.size(); s < end; ++s) {
+            auto other = my_selection[s];
+            Value_ val;
+            bool nonzero = (my_row ? my_generator.get(i, other, val) : my_generator.get(other, i, val));
+            if (nonzero) {
+                if (my_needs_value) {
+                    vbuffer[count] = val;
+                }
+                if (my_needs_index) {
+                    ibuffer[count] = other;
+                }
+                ++count;
+            }
+        }
+        return tatami::SparseRange<Value_, Index_>(count, (my_needs_value ? vbuffer : NULL), (my_needs_index ? ibuffer : NULL));
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Procedurally generated matrix.
+ * @tparam Value_ Type of matrix value.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * Each value of this matrix is computed on demand from a stateless hash of its row index, column index and the seed.
+ * A value is a structural zero if its hash-derived uniform variate is greater than the density, otherwise it is sampled uniformly between the lower and upper bounds.
+ * No memory is used to store the values, so this matrix can be used as a `reference` in `test_full_access()` and friends for matrices with very large dimensions,
+ * e.g., to test 64-bit `Index_` types or matrices with more than 2^31 elements.
+ * It can also be used as a seed for stress-testing delayed operations at such dimensions.
+ *
+ * Extraction is supported in all forms (dense/sparse, myopic/oracular, full/block/indexed) for both rows and columns.
+ * The cost of each extraction is proportional to the number of requested elements in the non-target dimension.
+ */
+template<typename Value_, typename Index_>
+class ProceduralMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param nrow Number of rows.
+     * @param ncol Number of columns.
+     * @param options Further options.
+     */
+    ProceduralMatrix(Index_ nrow, Index_ ncol, const ProceduralMatrixOptions& options) :
+        my_nrow(nrow), my_ncol(ncol), my_generator(options), my_prefer_rows(options.prefer_rows) {}
+
+private:
+    Index_ my_nrow, my_ncol;
+    internal::ProceduralGenerator<Value_> my_generator;
+    bool my_prefer_rows;
+
+public:
+    Index_ nrow() const {
+        return my_nrow;
+    }
+
+    Index_ ncol() const {
+        return my_ncol;
+    }
+
+    bool is_sparse() const {
+        return my_generator.is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return static_cast<double>(my_generator.is_sparse());
+    }
+
+    bool prefer_rows() const {
+        return my_prefer_rows;
+    }
+
+    double prefer_rows_proportion() const {
+        return static_cast<double>(my_prefer_rows);
+    }
+
+    bool uses_oracle(bool) const {
+        return false;
+    }
+
+private:
+    Index_ secondary(bool row) const {
+        return (row ? my_ncol : my_nrow);
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::DenseExtractor<oracle_, Value_, Index_> > dense_internal(bool row, tatami::MaybeOracle<oracle_, Index_> ora, internal::ProceduralSelection<Index_> sel) const {
+        return std::make_unique<internal::ProceduralDenseExtractor<oracle_, Value_, Index_> >(my_generator, row, std::move(ora), std::move(sel));
+    }
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, Value_, Index_> > sparse_internal(bool row, tatami::MaybeOracle<oracle_, Index_> ora, internal::ProceduralSelection<Index_> sel, const tatami::Options& opt) const {
+        return std::make_unique<internal::ProceduralSparseExtractor<oracle_, Value_, Index_> >(my_generator, row, std::move(ora), std::move(sel), opt);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, const tatami::Options&) const {
+        return dense_internal<false>(row, false, internal::ProceduralSelection<Index_>(0, secondary(row)));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, Index_ bs, Index_ bl, const tatami::Options&) const {
+        return dense_internal<false>(row, false, internal::ProceduralSelection<Index_>(bs, bl));
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options&) const {
+        return dense_internal<false>(row, false, internal::ProceduralSelection<Index_>(std::move(idx)));
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, internal::ProceduralSelection<Index_>(0, secondary(row)), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, internal::ProceduralSelection<Index_>(bs, bl), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(bool row, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return sparse_internal<false>(row, false, internal::ProceduralSelection<Index_>(std::move(idx)), opt);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(0, secondary(row)));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(bs, bl));
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options&) const {
+        return dense_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(std::move(idx)));
+    }
+
+public:
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(0, secondary(row)), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, Index_ bs, Index_ bl, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(bs, bl), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(bool row, std::shared_ptr<const tatami::Oracle<Index_> > ora, tatami::VectorPtr<Index_> idx, const tatami::Options& opt) const {
+        return sparse_internal<true>(row, std::move(ora), internal::ProceduralSelection<Index_>(std::move(idx)), opt);
+    }
+};
+
+}
+
+#endif
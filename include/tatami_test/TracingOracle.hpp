@@ -0,0 +1,102 @@
+#ifndef TATAMI_TEST_TRACING_ORACLE_HPP
+#define TATAMI_TEST_TRACING_ORACLE_HPP
+
+#include "tatami/base/Oracle.hpp"
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @file TracingOracle.hpp
+ * @brief Trace the consumption of predictions from an oracle.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Trace the consumption of predictions from an oracle.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * This wraps an existing `tatami::Oracle` and records each call to `get()`.
+ * The caller should report the number of `fetch()` calls that have been made with `set_position()`,
+ * allowing the `TracingOracle` to determine how far ahead each `get()` call is reading, i.e., the prefetch depth.
+ * The peak prefetch depth is an upper bound on the number of rows/columns that an oracle-aware extractor might cache at any given time,
+ * and can be used to detect extractors that pull the entire prediction stream up front.
+ */
+template<typename Index_>
+class TracingOracle final : public tatami::Oracle<Index_> {
+public:
+    /**
+     * @param oracle Pointer to an existing oracle.
+     */
+    TracingOracle(std::shared_ptr<const tatami::Oracle<Index_> > oracle) : my_oracle(std::move(oracle)) {}
+
+private:
+    std::shared_ptr<const tatami::Oracle<Index_> > my_oracle;
+    std::atomic<size_t> my_position{0};
+    mutable std::atomic<size_t> my_gets{0};
+    mutable std::atomic<size_t> my_peak{0};
+    mutable std::atomic<size_t> my_out_of_range{0};
+
+public:
+    /**
+     * @cond
+     */
+    size_t total() const {
+        return my_oracle->total();
+    }
+
+    Index_ get(size_t i) const {
+        ++my_gets;
+        if (i >= my_oracle->total()) {
+            ++my_out_of_range;
+        }
+
+        size_t position = my_position.load();
+        if (i > position) {
+            size_t depth = i - position;
+            size_t current = my_peak.load();
+            while (depth > current && !my_peak.compare_exchange_weak(current, depth)) {}
+        }
+
+        return my_oracle->get(i);
+    }
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param position Index of the prediction that is currently being fetched, i.e., the number of `fetch()` calls that have already been completed.
+     */
+    void set_position(size_t position) {
+        my_position.store(position);
+    }
+
+    /**
+     * @return Total number of calls to `get()`.
+     */
+    size_t gets() const {
+        return my_gets.load();
+    }
+
+    /**
+     * @return Peak prefetch depth, i.e., the maximum difference between the index of the prediction requested by `get()` and the current position.
+     * This is zero if predictions are only ever requested for the current `fetch()` call.
+     */
+    size_t peak_depth() const {
+        return my_peak.load();
+    }
+
+    /**
+     * @return Number of `get()` calls that requested a prediction beyond the end of the oracle, i.e., greater than or equal to `total()`.
+     */
+    size_t out_of_range() const {
+        return my_out_of_range.load();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef TATAMI_TEST_ACCESS_SEQUENCE_HPP
+#define TATAMI_TEST_ACCESS_SEQUENCE_HPP
+
+#include "tatami/base/Oracle.hpp"
+#include "tatami/utils/new_extractor.hpp"
+#include "tatami/utils/ConsecutiveOracle.hpp"
+#include "tatami/utils/FixedOracle.hpp"
+
+#include "create_indexed_subset.hpp"
+
+#include <vector>
+#include <limits>
+#include <random>
+#include <cmath>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+/**
+ * @file access_sequence.hpp
+ * @brief Options and sequences of rows/columns for access tests and benchmarks.
+ *
+ * This does not depend on GoogleTest, so it can be used by standalone benchmarking executables.
+ */
+
+namespace tatami_test {
+
+/**
+ * Order for accessing rows/columns during `tatami::Matrix` access tests. 
+ *
+ * - `FORWARD`: rows/columns are accessed in strictly increasing order.
+ * - `REVERSE`: rows/columns are accessed in strictly decreasing order.
+ * - `RANDOM`: rows/columns are accessed in random order.
+ * - `CHUNKED`: rows/columns are split into consecutive chunks, which are accessed in decreasing order.
+ *   Rows/columns within each chunk are accessed in increasing order, so each chunk is a forward sweep followed by a backward restart.
+ * - `ZIGZAG`: rows/columns are accessed in increasing order and then in decreasing order, i.e., each row/column is accessed twice.
+ * - `REPEATED`: rows/columns are accessed in increasing order, but each row/column is accessed 1-3 times in succession.
+ * - `CLUSTERED`: rows/columns are split into consecutive chunks, which are accessed in random order.
+ *   Rows/columns within each chunk are also accessed in random order, mimicking random access with some locality.
+ *
+ * For `CHUNKED` and `CLUSTERED`, the chunk size is the (rounded) square root of the number of rows/columns to be accessed.
+ */
+enum class TestAccessOrder : char { FORWARD, REVERSE, RANDOM, CHUNKED, ZIGZAG, REPEATED, CLUSTERED };
+
+/**
+ * @brief Options for `test_full_access()` and friends.
+ */
+struct TestAccessOptions {
+    /**
+     * Whether to use an oracle.
+     */
+    bool use_oracle = false;
+
+    /**
+     * Whether to test row access. 
+     * If `false`, column access is tested instead.
+     */
+    bool use_row = true;
+
+    /**
+     * Ordering of row/column accesses in the test.
+     */
+    TestAccessOrder order = TestAccessOrder::FORWARD;
+
+    /**
+     * Minimum distance between rows/columns to be accessed in the test.
+     */
+    int jump = 1;
+
+    /**
+     * Whether to check that "sparse" matrices actually have density below 1.
+     */
+    bool check_sparse = true;
+
+    /**
+     * Number of threads to use for testing.
+     * The sequence of rows/columns to be accessed is split into contiguous intervals, one per thread, via `tatami::parallelize()`.
+     * Each thread creates its own extractors (and oracle, if `TestAccessOptions::use_oracle = true`) to process its interval.
+     * This speeds up the tests for large matrices while also checking that extraction works when multiple extractors are used concurrently.
+     */
+    int num_threads = 1;
+
+    /**
+     * Whether to extract the reference matrix in sparse form.
+     * If `true`, the results of sparse extraction from the tested matrix are directly compared to the non-zero (index, value) pairs from the reference,
+     * rather than to a dense row/column from a dense reference extractor.
+     * This avoids the cost of dense extraction from the reference, which is most useful for very sparse matrices where the reference is a sparse matrix, e.g., `tatami::CompressedSparseMatrix`.
+     * Note that dense extraction from the tested matrix is still checked, so the cost of testing each row/column remains proportional to the extent of the non-target dimension.
+     */
+    bool sparse_reference = false;
+
+    /**
+     * Maximum acceptable prefetch depth for oracular extraction, see `TracingOracle::peak_depth()`.
+     * If `TestAccessOptions::use_oracle = true`, the peak prefetch depth across all extractors is checked against this value.
+     * It is also recorded as the `peak_prefetch_depth` property via GoogleTest's `RecordProperty()`.
+     * By default, no limit is imposed.
+     */
+    size_t max_prefetch_depth = std::numeric_limits<size_t>::max();
+
+    /**
+     * Whether to pass `GuardedBuffer`s to `fetch()` on the tested matrix's extractors.
+     * Any write past the end of the output buffers will then cause an immediate segmentation fault,
+     * providing a cheaper alternative to AddressSanitizer for large matrices in release builds.
+     * Writes before the start of the buffers are also detected, see `GuardedBuffer::intact()`.
+     */
+    bool guard_buffers = false;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<typename Index_>
+uint64_t create_seed(Index_ NR, Index_ NC, const TestAccessOptions& options) {
+    uint64_t seed = static_cast<uint64_t>(NR) * static_cast<uint64_t>(NC);
+    seed += 13 * static_cast<uint64_t>(options.use_row);
+    seed += 57 * static_cast<uint64_t>(options.order);
+    seed += 101 * static_cast<uint64_t>(options.jump);
+    return seed;
+}
+
+template<typename Index_>
+std::vector<Index_> simulate_test_access_sequence(Index_ NR, Index_ NC, const TestAccessOptions& options) {
+    std::vector<Index_> sequence;
+    auto limit = (options.use_row ? NR : NC);
+
+    std::mt19937_64 rng(create_seed(NR, NC, options));
+    Index_ start = rng() % options.jump;
+    if (start < limit) {
+        while (1) {
+            sequence.push_back(start);
+            Index_ remainder = limit - start;
+            // Make sure this comparison involves two unsigned integers to avoid GCC warnings.
+            if (static_cast<typename std::make_unsigned<Index_>::type>(remainder) <= static_cast<typename std::make_unsigned<int>::type>(options.jump)) {
+                break;
+            }
+            start += options.jump;
+        }
+    }
+
+    if (options.order == TestAccessOrder::REVERSE) {
+        std::reverse(sequence.begin(), sequence.end());
+
+    } else if (options.order == TestAccessOrder::RANDOM) {
+        std::shuffle(sequence.begin(), sequence.end(), rng);
+
+    } else if (options.order == TestAccessOrder::ZIGZAG) {
+        size_t n = sequence.size();
+        sequence.reserve(n * 2);
+        for (size_t i = n; i > 0; --i) {
+            sequence.push_back(sequence[i - 1]);
+        }
+
+    } else if (options.order == TestAccessOrder::REPEATED) {
+        std::vector<Index_> repeated;
+        repeated.reserve(sequence.size() * 3);
+        for (auto i : sequence) {
+            int times = 1 + rng() % 3;
+            repeated.insert(repeated.end(), times, i);
+        }
+        sequence.swap(repeated);
+
+    } else if (options.order == TestAccessOrder::CHUNKED || options.order == TestAccessOrder::CLUSTERED) {
+        size_t n = sequence.size();
+        size_t chunk_size = std::max(static_cast<size_t>(1), static_cast<size_t>(std::round(std::sqrt(static_cast<double>(n)))));
+        std::vector<size_t> chunk_starts;
+        for (size_t c = 0; c < n; c += chunk_size) {
+            chunk_starts.push_back(c);
+        }
+
+        if (options.order == TestAccessOrder::CHUNKED) {
+            std::reverse(chunk_starts.begin(), chunk_starts.end());
+        } else {
+            std::shuffle(chunk_starts.begin(), chunk_starts.end(), rng);
+        }
+
+        std::vector<Index_> reordered;
+        reordered.reserve(n);
+        for (auto c : chunk_starts) {
+            size_t chunk_end = std::min(n, c + chunk_size);
+            auto reordered_start = reordered.end() - reordered.begin();
+            reordered.insert(reordered.end(), sequence.begin() + c, sequence.begin() + chunk_end);
+            if (options.order == TestAccessOrder::CLUSTERED) {
+                std::shuffle(reordered.begin() + reordered_start, reordered.end(), rng);
+            }
+        }
+        sequence.swap(reordered);
+    }
+
+    return sequence;
+}
+
+template<bool use_oracle_, typename Index_>
+tatami::MaybeOracle<use_oracle_, Index_> create_oracle(const Index_* sequence, size_t length, const TestAccessOptions& options) {
+    if constexpr(use_oracle_) {
+        std::shared_ptr<tatami::Oracle<Index_> > oracle;
+        if (options.jump == 1 && options.order == TestAccessOrder::FORWARD && length) {
+            oracle.reset(new tatami::ConsecutiveOracle<Index_>(sequence[0], length));
+        } else {
+            oracle.reset(new tatami::FixedViewOracle<Index_>(sequence, length));
+        }
+        return oracle;
+    } else {
+        return false;
+    }
+}
+
+template<bool use_oracle_, typename Index_>
+tatami::MaybeOracle<use_oracle_, Index_> create_oracle(const std::vector<Index_>& sequence, const TestAccessOptions& options) {
+    return create_oracle<use_oracle_>(sequence.data(), sequence.size(), options);
+}
+
+// Same indexed subset as test_indexed_access(), so that the benchmarks and counters use the same subset as the tests.
+template<typename Index_>
+tatami::VectorPtr<Index_> create_test_indexed_subset(Index_ NR, Index_ NC, double relative_start, double probability, const TestAccessOptions& options) {
+    return create_indexed_subset(
+        (options.use_row ? NC : NR),
+        relative_start,
+        probability,
+        create_seed(NR, NC, options) + 999 * probability + 85 * relative_start
+    );
+}
+
+// Same indexed subset as test_unsorted_indexed_access(), so that benchmark_unsorted_indexed_access() uses the same subset as the test.
+template<typename Index_>
+tatami::VectorPtr<Index_> create_test_unsorted_indexed_subset(Index_ NR, Index_ NC, double relative_start, double probability, const TestAccessOptions& options) {
+    return create_indexed_subset(
+        (options.use_row ? NC : NR),
+        relative_start,
+        probability,
+        create_seed(NR, NC, options) + 1001 * probability + 13 * relative_start
+    );
+}
+
+template<class Result_, typename = void>
+struct has_sparse_count : std::false_type {};
+
+template<class Result_>
+struct has_sparse_count<Result_, std::void_t<decltype(std::declval<Result_>().sparse_count)> > : std::true_type {};
+
+// Calls 'fun(sparse, opt, target)' for each of the extractors in test_full_access() and friends, where 'sparse' is a std::integral_constant<bool, ...>.
+// 'target' is the corresponding member of 'result', which should have 'dense', 'sparse', 'sparse_value', 'sparse_index' and (optionally) 'sparse_count' members.
+template<class Result_, class Function_>
+void for_each_extractor_kind(Result_& result, Function_ fun) {
+    tatami::Options opt;
+    fun(std::false_type(), opt, result.dense);
+    fun(std::true_type(), opt, result.sparse);
+
+    opt.sparse_extract_index = false;
+    fun(std::true_type(), opt, result.sparse_value);
+
+    opt.sparse_extract_value = false;
+    if constexpr(has_sparse_count<Result_>::value) {
+        fun(std::true_type(), opt, result.sparse_count);
+    }
+
+    opt.sparse_extract_index = true;
+    fun(std::true_type(), opt, result.sparse_index);
+}
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
@@ -0,0 +1,424 @@
+#ifndef TATAMI_TEST_BENCHMARK_ACCESS_HPP
+#define TATAMI_TEST_BENCHMARK_ACCESS_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/new_extractor.hpp"
+
+#include "access_sequence.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @file benchmark_access.hpp
+ * @brief Benchmark access patterns on a `tatami::Matrix`.
+ *
+ * This does not require GoogleTest if `TATAMI_TEST_NO_GTEST` is defined, see `report_check_failure.hpp`.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for `benchmark_full_access()` and friends.
+ */
+struct BenchmarkAccessOptions {
+    /**
+     * Number of times to repeat the benchmark for each extractor.
+     * The fastest time is reported for each extractor, to reduce the effect of noise and warm-up.
+     */
+    int repeats = 3;
+};
+
+/**
+ * @brief Timing for a single extractor in `benchmark_full_access()` and friends.
+ */
+struct BenchmarkAccessTiming {
+    /**
+     * Number of calls to `fetch()`.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Total number of elements returned by all `fetch()` calls.
+     * For dense extractors, this is the product of `fetches` and the number of elements extracted from each row/column.
+     * For sparse extractors, this is the total number of structural non-zeros.
+     */
+    size_t elements = 0;
+
+    /**
+     * Total number of bytes returned by all `fetch()` calls, i.e., `elements` multiplied by the size of the value and/or index types that were extracted.
+     * This is zero for sparse extraction where neither values nor indices are requested.
+     */
+    size_t bytes = 0;
+
+    /**
+     * Total time spent in all `fetch()` calls, in seconds.
+     */
+    double seconds = 0;
+
+    /**
+     * @return Average time per `fetch()` call, in nanoseconds.
+     */
+    double ns_per_fetch() const {
+        return (fetches ? seconds * 1e9 / fetches : 0);
+    }
+
+    /**
+     * @return Average time per returned element, in nanoseconds.
+     */
+    double ns_per_element() const {
+        return (elements ? seconds * 1e9 / elements : 0);
+    }
+
+    /**
+     * @return Throughput in bytes per second.
+     */
+    double bytes_per_second() const {
+        return (seconds > 0 ? bytes / seconds : 0);
+    }
+};
+
+/**
+ * @brief Results of `benchmark_full_access()` and friends.
+ *
+ * Each member corresponds to one of the extractors that are tested in `test_full_access()` and friends.
+ */
+struct BenchmarkAccessResult {
+    /**
+     * Timing for dense extraction.
+     */
+    BenchmarkAccessTiming dense;
+
+    /**
+     * Timing for sparse extraction of both values and indices.
+     */
+    BenchmarkAccessTiming sparse;
+
+    /**
+     * Timing for sparse extraction of indices only, i.e., `tatami::Options::sparse_extract_value = false`.
+     */
+    BenchmarkAccessTiming sparse_index;
+
+    /**
+     * Timing for sparse extraction of values only, i.e., `tatami::Options::sparse_extract_index = false`.
+     */
+    BenchmarkAccessTiming sparse_value;
+
+    /**
+     * Timing for sparse extraction of the number of non-zeros only,
+     * i.e., both `tatami::Options::sparse_extract_value` and `tatami::Options::sparse_extract_index` are false.
+     */
+    BenchmarkAccessTiming sparse_count;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAccessTiming benchmark_access_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const Index_* sequence,
+    size_t length,
+    const TestAccessOptions& options,
+    Index_ extent,
+    const tatami::Options& opt,
+    Args_... args)
+{
+    auto oracle = create_oracle<use_oracle_>(sequence, length, options);
+    auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+    std::vector<Value_> vbuffer(extent);
+    std::vector<Index_> ibuffer(extent);
+
+    BenchmarkAccessTiming output;
+    output.fetches = length;
+    auto start = std::chrono::steady_clock::now();
+
+    if constexpr(sparse_) {
+        auto vptr = (opt.sparse_extract_value ? vbuffer.data() : NULL);
+        auto iptr = (opt.sparse_extract_index ? ibuffer.data() : NULL);
+        for (size_t s = 0; s < length; ++s) {
+            auto range = [&]() {
+                if constexpr(use_oracle_) {
+                    return ext->fetch(vptr, iptr);
+                } else {
+                    return ext->fetch(sequence[s], vptr, iptr);
+                }
+            }();
+            output.elements += range.number;
+        }
+    } else {
+        for (size_t s = 0; s < length; ++s) {
+            if constexpr(use_oracle_) {
+                ext->fetch(vbuffer.data());
+            } else {
+                ext->fetch(sequence[s], vbuffer.data());
+            }
+        }
+        output.elements = static_cast<size_t>(extent) * length;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    output.seconds = std::chrono::duration<double>(end - start).count();
+
+    size_t element_size = 0;
+    if (!sparse_ || opt.sparse_extract_value) {
+        element_size += sizeof(Value_);
+    }
+    if (sparse_ && opt.sparse_extract_index) {
+        element_size += sizeof(Index_);
+    }
+    output.bytes = output.elements * element_size;
+
+    return output;
+}
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAccessTiming benchmark_access_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    Index_ extent,
+    const tatami::Options& opt,
+    Args_... args)
+{
+    return benchmark_access_extractor<use_oracle_, sparse_>(matrix, sequence.data(), sequence.size(), options, extent, opt, args...);
+}
+
+// Works for any timing class with a 'seconds' member, e.g., BenchmarkAccessTiming or the points of the other benchmarks.
+template<class Timing_>
+void keep_fastest_timing(Timing_& best, const Timing_& current, bool first) {
+    if (first || current.seconds < best.seconds) {
+        best = current;
+    }
+}
+
+// Calls 'fun()' for at least one and up to 'repeats' times, returning the timing with the smallest 'seconds'.
+template<class Function_>
+auto repeat_fastest_timing(int repeats, Function_ fun) {
+    auto best = fun();
+    for (int r = 1; r < repeats; ++r) {
+        keep_fastest_timing(best, fun(), false);
+    }
+    return best;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAccessResult benchmark_access_base(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options,
+    Index_ extent,
+    Args_... args)
+{
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    BenchmarkAccessResult output;
+
+    // Collecting the extractor configurations so that they can be run in a different order in each repeat.
+    std::vector<std::function<void(bool)> > runs;
+    for_each_extractor_kind(output, [&](auto sparse, const tatami::Options& opt, BenchmarkAccessTiming& target) -> void {
+        runs.emplace_back([&, opt, tptr = &target](bool first) -> void {
+            keep_fastest_timing(*tptr, benchmark_access_extractor<use_oracle_, decltype(sparse)::value>(matrix, sequence, options, extent, opt, args...), first);
+        });
+    });
+
+    // Cycling through all extractors in each repeat and taking the fastest time for each,
+    // so that the first pass for each extractor does not include warm-up costs.
+    // The order of extractors is reversed in every other repeat so that no extractor is consistently favored by its position.
+    size_t num_runs = runs.size();
+    for (int r = 0, nrep = std::max(benchmark_options.repeats, 1); r < nrep; ++r) {
+        for (size_t k = 0; k < num_runs; ++k) {
+            runs[r % 2 == 0 ? k : num_runs - k - 1](r == 0);
+        }
+    }
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_full_access(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkAccessOptions& benchmark_options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return benchmark_access_base<use_oracle_>(matrix, options, benchmark_options, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_block_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options)
+{
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return benchmark_access_base<use_oracle_>(matrix, options, benchmark_options, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_indexed_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options)
+{
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return benchmark_access_base<use_oracle_>(matrix, options, benchmark_options, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Benchmark access to the full extent of each row/column.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * No GoogleTest assertions are performed, so this can be used in standalone benchmarking executables.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_full_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_full_access<true>(matrix, options, benchmark_options);
+    } else {
+        return internal::benchmark_full_access<false>(matrix, options, benchmark_options);
+    }
+}
+
+/**
+ * Benchmark access to a contiguous block of each row/column.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * No GoogleTest assertions are performed, so this can be used in standalone benchmarking executables.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_block_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_block_access<true>(matrix, relative_start, relative_length, options, benchmark_options);
+    } else {
+        return internal::benchmark_block_access<false>(matrix, relative_start, relative_length, options, benchmark_options);
+    }
+}
+
+/**
+ * Benchmark access to an indexed subset of each row/column.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`, using the same indexed subset.
+ * No GoogleTest assertions are performed, so this can be used in standalone benchmarking executables.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+BenchmarkAccessResult benchmark_indexed_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_indexed_access<true>(matrix, relative_start, probability, options, benchmark_options);
+    } else {
+        return internal::benchmark_indexed_access<false>(matrix, relative_start, probability, options, benchmark_options);
+    }
+}
+
+/**
+ * Check that sparse extraction becomes cheaper when less information is requested,
+ * i.e., the time spent extracting the number of non-zeros only should be no greater than that of indices only or values only,
+ * which in turn should be no greater than that of extracting both indices and values.
+ * Violations suggest that the matrix is not skipping work when `tatami::Options::sparse_extract_value` or `tatami::Options::sparse_extract_index` is `false`,
+ * e.g., a file-backed matrix that decodes values that were never requested.
+ * This is most reliable when `result` is generated with `BenchmarkAccessOptions::repeats` greater than 1, as the fastest time for each extractor is compared.
+ *
+ * Note that the timings are subject to noise, so `result` should be generated from a matrix that is large enough for the differences in extraction cost to be measurable.
+ *
+ * @param result Result of `benchmark_full_access()` or friends.
+ * @param tolerance Maximum acceptable ratio of the time spent in the cheaper extraction to that of the more expensive extraction.
+ * Values greater than 1 allow for some noise in the timings.
+ * @param fail Whether to raise a GoogleTest error if any ratio exceeds `tolerance`.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether all ratios are no greater than `tolerance`.
+ */
+inline bool check_sparse_cost_hierarchy(const BenchmarkAccessResult& result, double tolerance = 1.2, bool fail = true) {
+    std::ostringstream msg;
+    bool okay = true;
+
+    auto compare = [&](const BenchmarkAccessTiming& cheaper, const char* cheaper_name, const BenchmarkAccessTiming& pricier, const char* pricier_name) -> void {
+        if (cheaper.seconds <= pricier.seconds * tolerance) {
+            return;
+        }
+        msg << "\n  " << cheaper_name << " extraction (" << cheaper.seconds << " s) is slower than " << pricier_name << " extraction (" << pricier.seconds << " s)";
+        okay = false;
+    };
+
+    compare(result.sparse_count, "count-only", result.sparse_index, "index-only");
+    compare(result.sparse_count, "count-only", result.sparse_value, "value-only");
+    compare(result.sparse_index, "index-only", result.sparse, "full sparse");
+    compare(result.sparse_value, "value-only", result.sparse, "full sparse");
+    if (okay) {
+        return true;
+    }
+
+    std::ostringstream full;
+    full << "violations of the sparse extraction cost hierarchy (tolerance of " << tolerance << "):" << msg.str();
+    internal::report_check_failure(fail, full.str());
+    return false;
+}
+
+}
+
+#endif
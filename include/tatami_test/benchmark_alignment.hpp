@@ -0,0 +1,426 @@
+#ifndef TATAMI_TEST_BENCHMARK_ALIGNMENT_HPP
+#define TATAMI_TEST_BENCHMARK_ALIGNMENT_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/new_extractor.hpp"
+#include "tatami/utils/copy.hpp"
+
+#include "test_access.hpp"
+#include "benchmark_access.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file benchmark_alignment.hpp
+ * @brief Verify and benchmark extraction into output buffers with different alignments.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for `benchmark_full_alignment()` and friends.
+ */
+struct BenchmarkAlignmentOptions {
+    /**
+     * Offsets of the output buffers from a 64-byte boundary, in terms of the number of elements.
+     * An offset of zero yields 64-byte aligned buffers, while an offset of 1 yields buffers that are misaligned by one element.
+     * If empty, all offsets from 0 to `64 / sizeof(Value_) - 1` are used.
+     */
+    std::vector<size_t> offsets;
+
+    /**
+     * Whether to use sparse extraction.
+     * If `false`, dense extraction is used instead.
+     */
+    bool sparse = false;
+
+    /**
+     * Number of times to repeat the benchmark for each offset.
+     * The fastest time is reported, to reduce the effect of noise.
+     */
+    int repeats = 3;
+};
+
+/**
+ * @brief Results of `benchmark_full_alignment()` and friends for a single buffer offset.
+ */
+struct BenchmarkAlignmentPoint {
+    /**
+     * Offset of the output buffers from a 64-byte boundary, in terms of the number of elements.
+     */
+    size_t offset = 0;
+
+    /**
+     * Alignment of the value buffer in bytes, i.e., the largest power of 2 (up to 64) that divides its address.
+     */
+    size_t alignment = 0;
+
+    /**
+     * Alignment of the index buffer in bytes, defined in the same manner as `alignment`.
+     * This is only relevant for sparse extraction.
+     */
+    size_t index_alignment = 0;
+
+    /**
+     * Number of calls to `fetch()` in each benchmark run.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Total number of elements returned by all `fetch()` calls in each benchmark run.
+     */
+    size_t elements = 0;
+
+    /**
+     * Time spent in all `fetch()` calls in the fastest benchmark run, in seconds.
+     */
+    double seconds = 0;
+
+    /**
+     * Number of `fetch()` calls that returned a pointer to the extractor's own storage, rather than filling the supplied buffers.
+     * Sparse extraction uses the same definition as `ZeroCopyStatistics::zero_copy`.
+     */
+    size_t own_pointer = 0;
+
+    /**
+     * @return Throughput in elements per second.
+     */
+    double elements_per_second() const {
+        return (seconds > 0 ? elements / seconds : 0);
+    }
+
+    /**
+     * @return Proportion of `fetch()` calls that returned a pointer to the extractor's own storage.
+     */
+    double own_pointer_fraction() const {
+        return (fetches ? static_cast<double>(own_pointer) / fetches : 0);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline constexpr size_t alignment_boundary = 64;
+
+inline size_t pointer_alignment(const void* ptr) {
+    auto address = reinterpret_cast<uintptr_t>(ptr);
+    size_t alignment = 1;
+    while (alignment < alignment_boundary && address % (alignment * 2) == 0) {
+        alignment *= 2;
+    }
+    return alignment;
+}
+
+template<typename Type_>
+class OffsetBuffer {
+public:
+    OffsetBuffer(size_t n, size_t offset) : my_storage((n + offset) * sizeof(Type_) + alignment_boundary) {
+        auto address = reinterpret_cast<uintptr_t>(my_storage.data());
+        size_t shift = (alignment_boundary - address % alignment_boundary) % alignment_boundary;
+        my_data = reinterpret_cast<Type_*>(my_storage.data() + shift + offset * sizeof(Type_));
+    }
+
+    Type_* data() {
+        return my_data;
+    }
+
+private:
+    std::vector<unsigned char> my_storage;
+    Type_* my_data;
+};
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAlignmentPoint benchmark_alignment_offset(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    Index_ extent,
+    size_t offset,
+    int repeats,
+    Args_... args)
+{
+    OffsetBuffer<Value_> vbuffer(extent, offset);
+    OffsetBuffer<Index_> ibuffer(extent, offset);
+    BenchmarkAlignmentPoint output;
+    output.offset = offset;
+    output.alignment = pointer_alignment(vbuffer.data());
+    output.index_alignment = pointer_alignment(ibuffer.data());
+    output.fetches = sequence.size();
+
+    // Verifying the results against extraction from the reference into plain vectors.
+    {
+        auto oracle = create_oracle<use_oracle_>(sequence, options);
+        auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args...);
+        auto ref = tatami::new_extractor<sparse_, false>(&reference, options.use_row, false, args...);
+
+        if constexpr(sparse_) {
+            SparseVector<Value_, Index_> expected, observed;
+            for (auto i : sequence) {
+                fetch(*ref, i, extent, expected);
+
+                auto raw = [&]() {
+                    if constexpr(use_oracle_) {
+                        return ext->fetch(vbuffer.data(), ibuffer.data());
+                    } else {
+                        return ext->fetch(i, vbuffer.data(), ibuffer.data());
+                    }
+                }();
+                output.own_pointer += returned_own_pointer(raw, vbuffer.data(), ibuffer.data());
+                observed.value.resize(extent);
+                observed.index.resize(extent);
+                trim_sparse(raw, observed.value, observed.index);
+                compare_sparse_vectors(expected, observed, "sparse retrieval into offset buffers", i);
+            }
+        } else {
+            std::vector<Value_> expected, observed(extent);
+            for (auto i : sequence) {
+                fetch(*ref, i, extent, expected);
+
+                auto raw = [&]() {
+                    if constexpr(use_oracle_) {
+                        return ext->fetch(vbuffer.data());
+                    } else {
+                        return ext->fetch(i, vbuffer.data());
+                    }
+                }();
+                output.own_pointer += returned_own_pointer(raw, vbuffer.data());
+                tatami::copy_n(raw, extent, observed.data());
+                compare_vectors(expected, observed, "dense retrieval into offset buffers", i);
+            }
+        }
+    }
+
+    auto fastest = repeat_fastest_timing(repeats, [&]() -> BenchmarkAccessTiming {
+        auto oracle = create_oracle<use_oracle_>(sequence, options);
+        auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args...);
+        BenchmarkAccessTiming timing;
+        timing.fetches = sequence.size();
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i : sequence) {
+            if constexpr(sparse_) {
+                auto range = [&]() {
+                    if constexpr(use_oracle_) {
+                        return ext->fetch(vbuffer.data(), ibuffer.data());
+                    } else {
+                        return ext->fetch(i, vbuffer.data(), ibuffer.data());
+                    }
+                }();
+                timing.elements += range.number;
+            } else {
+                if constexpr(use_oracle_) {
+                    ext->fetch(vbuffer.data());
+                } else {
+                    ext->fetch(i, vbuffer.data());
+                }
+                timing.elements += extent;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        timing.seconds = std::chrono::duration<double>(end - start).count();
+        return timing;
+    });
+
+    output.seconds = fastest.seconds;
+    output.elements = fastest.elements;
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+std::vector<BenchmarkAlignmentPoint> benchmark_alignment_base(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options,
+    Index_ extent,
+    Args_... args)
+{
+    std::vector<BenchmarkAlignmentPoint> output;
+    if (matrix.nrow() != reference.nrow() || matrix.ncol() != reference.ncol()) {
+        report_check_failure(true, "matrix and reference should have the same dimensions");
+        return output;
+    }
+
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+
+    auto offsets = alignment_options.offsets;
+    if (offsets.empty()) {
+        size_t max_offset = std::max(alignment_boundary / sizeof(Value_), static_cast<size_t>(1));
+        offsets.resize(max_offset);
+        std::iota(offsets.begin(), offsets.end(), static_cast<size_t>(0));
+    }
+
+    output.reserve(offsets.size());
+    for (auto off : offsets) {
+        if (alignment_options.sparse) {
+            output.push_back(benchmark_alignment_offset<use_oracle_, true>(matrix, reference, sequence, options, extent, off, alignment_options.repeats, args...));
+        } else {
+            output.push_back(benchmark_alignment_offset<use_oracle_, false>(matrix, reference, sequence, options, extent, off, alignment_options.repeats, args...));
+        }
+    }
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_full_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return benchmark_alignment_base<use_oracle_>(matrix, reference, options, alignment_options, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_block_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return benchmark_alignment_base<use_oracle_>(matrix, reference, options, alignment_options, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_indexed_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return benchmark_alignment_base<use_oracle_>(matrix, reference, options, alignment_options, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Extract the full extent of each row/column into output buffers with different alignments.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * For each offset, the results are first checked against extraction from `reference`, raising a GoogleTest failure for any mismatches.
+ * The extraction is then benchmarked, allowing us to detect vectorized code paths that perform poorly (or break) with misaligned buffers.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param reference Reference matrix, containing the same values as `matrix` but with a different (and ideally simpler) representation, e.g., a `tatami::DenseMatrix`.
+ * This is used to check the results of extraction from `matrix` for each offset.
+ * @param options Further options for the access pattern.
+ * @param alignment_options Options for the buffer offsets.
+ *
+ * @return Throughput and the use of the extractor's own storage for each offset, in the same order as `BenchmarkAlignmentOptions::offsets`.
+ */
+template<typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_full_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    if (options.use_oracle) {
+        return internal::benchmark_full_alignment<true>(matrix, reference, options, alignment_options);
+    } else {
+        return internal::benchmark_full_alignment<false>(matrix, reference, options, alignment_options);
+    }
+}
+
+/**
+ * Extract a contiguous block of each row/column into output buffers with different alignments.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * See `benchmark_full_alignment()` for more details.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param reference Reference matrix, containing the same values as `matrix` but with a different (and ideally simpler) representation, e.g., a `tatami::DenseMatrix`.
+ * This is used to check the results of extraction from `matrix` for each offset.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for the access pattern.
+ * @param alignment_options Options for the buffer offsets.
+ *
+ * @return Throughput and the use of the extractor's own storage for each offset, in the same order as `BenchmarkAlignmentOptions::offsets`.
+ */
+template<typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_block_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    if (options.use_oracle) {
+        return internal::benchmark_block_alignment<true>(matrix, reference, relative_start, relative_length, options, alignment_options);
+    } else {
+        return internal::benchmark_block_alignment<false>(matrix, reference, relative_start, relative_length, options, alignment_options);
+    }
+}
+
+/**
+ * Extract an indexed subset of each row/column into output buffers with different alignments.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`, using the same indexed subset.
+ * See `benchmark_full_alignment()` for more details.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param reference Reference matrix, containing the same values as `matrix` but with a different (and ideally simpler) representation, e.g., a `tatami::DenseMatrix`.
+ * This is used to check the results of extraction from `matrix` for each offset.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for the access pattern.
+ * @param alignment_options Options for the buffer offsets.
+ *
+ * @return Throughput and the use of the extractor's own storage for each offset, in the same order as `BenchmarkAlignmentOptions::offsets`.
+ */
+template<typename Value_, typename Index_>
+std::vector<BenchmarkAlignmentPoint> benchmark_indexed_alignment(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAlignmentOptions& alignment_options)
+{
+    if (options.use_oracle) {
+        return internal::benchmark_indexed_alignment<true>(matrix, reference, relative_start, probability, options, alignment_options);
+    } else {
+        return internal::benchmark_indexed_alignment<false>(matrix, reference, relative_start, probability, options, alignment_options);
+    }
+}
+
+}
+
+#endif
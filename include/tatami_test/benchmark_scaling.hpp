@@ -0,0 +1,292 @@
+#ifndef TATAMI_TEST_BENCHMARK_SCALING_HPP
+#define TATAMI_TEST_BENCHMARK_SCALING_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include "benchmark_access.hpp"
+#include "access_sequence.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <sstream>
+#include <cstddef>
+
+/**
+ * @file benchmark_scaling.hpp
+ * @brief Check that the cost of block/indexed extraction scales with the size of the subset.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for `benchmark_block_scaling()` and `benchmark_indexed_scaling()`.
+ */
+struct BenchmarkScalingOptions {
+    /**
+     * Sizes of the subsets to benchmark.
+     * For `benchmark_block_scaling()`, these are used as the `relative_length` in `benchmark_block_access()`.
+     * For `benchmark_indexed_scaling()`, these are used as the `probability` in `benchmark_indexed_access()`.
+     * All values should lie in `(0, 1]`.
+     */
+    std::vector<double> sizes { 0.05, 0.1, 0.2, 0.4, 0.8 };
+
+    /**
+     * Start of the block or indexed subset, as a proportion of the extent of the non-target dimension.
+     * For `benchmark_block_scaling()`, the sum of this value and each entry of `BenchmarkScalingOptions::sizes` should be no greater than 1.
+     */
+    double relative_start = 0;
+
+    /**
+     * Whether to benchmark sparse extraction.
+     * If `false`, dense extraction is benchmarked instead.
+     */
+    bool sparse = false;
+
+    /**
+     * Number of times to repeat each benchmark.
+     * The fastest time is reported for each subset size, to reduce the effect of noise.
+     */
+    int repeats = 3;
+};
+
+/**
+ * @brief Timing for a single subset size in `benchmark_block_scaling()` and `benchmark_indexed_scaling()`.
+ */
+struct BenchmarkScalingPoint {
+    /**
+     * Size of the subset, taken from `BenchmarkScalingOptions::sizes`.
+     */
+    double size = 0;
+
+    /**
+     * Number of elements in the subset along the non-target dimension.
+     */
+    size_t number = 0;
+
+    /**
+     * Timing for extraction of the subset.
+     */
+    BenchmarkAccessTiming timing;
+};
+
+/**
+ * @brief Results of `benchmark_block_scaling()` and `benchmark_indexed_scaling()`.
+ *
+ * The per-fetch cost is modelled as a linear function of the number of elements in the subset, i.e., `intercept + slope * number`.
+ * For a matrix that only does work for the requested subset, the intercept should be a small fraction of the per-fetch cost of extracting the full extent.
+ * On the other hand, a matrix that extracts the full extent and then slices out the subset will have an intercept similar to the full extraction cost and a slope close to zero.
+ */
+struct BenchmarkScalingResult {
+    /**
+     * Timing for each subset size, in the same order as `BenchmarkScalingOptions::sizes`.
+     */
+    std::vector<BenchmarkScalingPoint> points;
+
+    /**
+     * Timing for extraction of the full extent of the non-target dimension.
+     */
+    BenchmarkAccessTiming full;
+
+    /**
+     * Slope of the least-squares fit of the per-fetch time (in nanoseconds) against the number of elements in the subset.
+     */
+    double slope = 0;
+
+    /**
+     * Intercept of the least-squares fit of the per-fetch time (in nanoseconds) against the number of elements in the subset.
+     */
+    double intercept = 0;
+
+    /**
+     * @return Ratio of `BenchmarkScalingResult::intercept` to the per-fetch time for full extraction.
+     * This is the proportion of the full extraction cost that is incurred regardless of the subset size.
+     * Values close to 1 indicate that the cost of block/indexed extraction does not depend on the subset size.
+     */
+    double fixed_fraction() const {
+        double denom = full.ns_per_fetch();
+        return (denom > 0 ? intercept / denom : 0);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAccessTiming benchmark_scaling_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    const BenchmarkScalingOptions& scaling_options,
+    Index_ extent,
+    Args_... args)
+{
+    tatami::Options opt;
+    return repeat_fastest_timing(scaling_options.repeats, [&]() -> BenchmarkAccessTiming {
+        return benchmark_access_extractor<use_oracle_, sparse_>(matrix, sequence, options, extent, opt, args...);
+    });
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkAccessTiming benchmark_scaling_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    const BenchmarkScalingOptions& scaling_options,
+    Index_ extent,
+    Args_... args)
+{
+    if (scaling_options.sparse) {
+        return benchmark_scaling_extractor<use_oracle_, true>(matrix, sequence, options, scaling_options, extent, args...);
+    } else {
+        return benchmark_scaling_extractor<use_oracle_, false>(matrix, sequence, options, scaling_options, extent, args...);
+    }
+}
+
+inline void fit_scaling(BenchmarkScalingResult& result) {
+    size_t npoints = result.points.size();
+    if (npoints == 0) {
+        return;
+    }
+
+    double mean_x = 0, mean_y = 0;
+    for (const auto& p : result.points) {
+        mean_x += p.number;
+        mean_y += p.timing.ns_per_fetch();
+    }
+    mean_x /= npoints;
+    mean_y /= npoints;
+
+    double sxx = 0, sxy = 0;
+    for (const auto& p : result.points) {
+        double dx = p.number - mean_x;
+        sxx += dx * dx;
+        sxy += dx * (p.timing.ns_per_fetch() - mean_y);
+    }
+
+    result.slope = (sxx > 0 ? sxy / sxx : 0);
+    result.intercept = mean_y - result.slope * mean_x;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkScalingResult benchmark_block_scaling(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkScalingOptions& scaling_options) {
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+
+    BenchmarkScalingResult output;
+    output.full = benchmark_scaling_extractor<use_oracle_>(matrix, sequence, options, scaling_options, nsecondary);
+
+    Index_ start = nsecondary * scaling_options.relative_start;
+    for (auto size : scaling_options.sizes) {
+        BenchmarkScalingPoint point;
+        point.size = size;
+        Index_ length = nsecondary * size;
+        point.number = length;
+        point.timing = benchmark_scaling_extractor<use_oracle_>(matrix, sequence, options, scaling_options, length, start, length);
+        output.points.push_back(point);
+    }
+
+    fit_scaling(output);
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkScalingResult benchmark_indexed_scaling(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkScalingOptions& scaling_options) {
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+
+    BenchmarkScalingResult output;
+    output.full = benchmark_scaling_extractor<use_oracle_>(matrix, sequence, options, scaling_options, nsecondary);
+
+    for (auto size : scaling_options.sizes) {
+        BenchmarkScalingPoint point;
+        point.size = size;
+        auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), scaling_options.relative_start, size, options);
+        Index_ num_indices = index_ptr->size();
+        point.number = num_indices;
+        point.timing = benchmark_scaling_extractor<use_oracle_>(matrix, sequence, options, scaling_options, num_indices, std::move(index_ptr));
+        output.points.push_back(point);
+    }
+
+    fit_scaling(output);
+    return output;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Benchmark block extraction for a range of block lengths, to check that the cost of extraction scales with the block length.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param options Further options for benchmarking.
+ * @param scaling_options Options for the range of block lengths.
+ *
+ * @return Timings for each block length, along with a linear fit of the per-fetch cost against the block length.
+ */
+template<typename Value_, typename Index_>
+BenchmarkScalingResult benchmark_block_scaling(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkScalingOptions& scaling_options) {
+    if (options.use_oracle) {
+        return internal::benchmark_block_scaling<true>(matrix, options, scaling_options);
+    } else {
+        return internal::benchmark_block_scaling<false>(matrix, options, scaling_options);
+    }
+}
+
+/**
+ * Benchmark indexed extraction for a range of sampling probabilities, to check that the cost of extraction scales with the number of indices.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param options Further options for benchmarking.
+ * @param scaling_options Options for the range of sampling probabilities.
+ *
+ * @return Timings for each sampling probability, along with a linear fit of the per-fetch cost against the number of indices.
+ */
+template<typename Value_, typename Index_>
+BenchmarkScalingResult benchmark_indexed_scaling(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkScalingOptions& scaling_options) {
+    if (options.use_oracle) {
+        return internal::benchmark_indexed_scaling<true>(matrix, options, scaling_options);
+    } else {
+        return internal::benchmark_indexed_scaling<false>(matrix, options, scaling_options);
+    }
+}
+
+/**
+ * Check that the cost of block/indexed extraction depends on the size of the subset.
+ * This flags matrices that extract the full extent of the non-target dimension and then slice out the subset.
+ *
+ * @param result Result of `benchmark_block_scaling()` or `benchmark_indexed_scaling()`.
+ * @param tolerance Maximum acceptable value of `BenchmarkScalingResult::fixed_fraction()`.
+ * @param fail Whether to raise a GoogleTest error if the fixed fraction exceeds `tolerance`.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether the fixed fraction is no greater than `tolerance`.
+ */
+inline bool check_access_scaling(const BenchmarkScalingResult& result, double tolerance = 0.5, bool fail = true) {
+    double fixed = result.fixed_fraction();
+    if (fixed <= tolerance) {
+        return true;
+    }
+
+    std::ostringstream msg;
+    msg << "cost of subset extraction does not scale with subset size (fixed fraction of " << fixed << " exceeds tolerance of " << tolerance << ")";
+    internal::report_check_failure(fail, msg.str());
+    return false;
+}
+
+}
+
+#endif
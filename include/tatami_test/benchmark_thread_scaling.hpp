@@ -0,0 +1,223 @@
+#ifndef TATAMI_TEST_BENCHMARK_THREAD_SCALING_HPP
+#define TATAMI_TEST_BENCHMARK_THREAD_SCALING_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/parallelize.hpp"
+
+#include "benchmark_access.hpp"
+#include "access_sequence.hpp"
+
+#include <vector>
+#include <chrono>
+#include <ostream>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @file benchmark_thread_scaling.hpp
+ * @brief Benchmark the scaling of extraction throughput with the number of threads.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for `benchmark_thread_scaling()`.
+ */
+struct BenchmarkThreadScalingOptions {
+    /**
+     * Numbers of threads to benchmark.
+     */
+    std::vector<int> num_threads { 1, 2, 4, 8 };
+
+    /**
+     * Whether to benchmark sparse extraction.
+     * If `false`, dense extraction is benchmarked instead.
+     */
+    bool sparse = false;
+
+    /**
+     * Number of times to repeat the benchmark for each number of threads.
+     * The fastest time is reported, to reduce the effect of noise.
+     */
+    int repeats = 1;
+};
+
+/**
+ * @brief Results of `benchmark_thread_scaling()` for a single number of threads.
+ */
+struct BenchmarkThreadScalingPoint {
+    /**
+     * Number of threads.
+     */
+    int num_threads = 0;
+
+    /**
+     * Number of threads that actually processed a non-empty interval of the access sequence.
+     * This may be less than `num_threads` if the sequence is short, as `tatami::parallelize()` does not start threads without any work.
+     */
+    int used_threads = 0;
+
+    /**
+     * Total number of calls to `fetch()` across all threads.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Total number of elements returned by all `fetch()` calls across all threads.
+     */
+    size_t elements = 0;
+
+    /**
+     * Wall-clock time, in seconds.
+     * This includes the construction of the extractors in each thread.
+     */
+    double seconds = 0;
+
+    /**
+     * Parallel efficiency, defined as the throughput per thread relative to that of the first entry of `BenchmarkThreadScalingOptions::num_threads`.
+     * If the first entry is 1, this is the usual definition of the speed-up divided by the number of threads.
+     * The throughput per thread is computed with `used_threads`, so idle threads do not reduce the efficiency.
+     * Values close to 1 indicate perfect scaling, while lower values indicate contention, e.g., from hidden locks or limited memory bandwidth.
+     */
+    double efficiency = 0;
+
+    /**
+     * @return Throughput in `fetch()` calls per second.
+     */
+    double fetches_per_second() const {
+        return (seconds > 0 ? fetches / seconds : 0);
+    }
+
+    /**
+     * @return Throughput in elements per second.
+     */
+    double elements_per_second() const {
+        return (seconds > 0 ? elements / seconds : 0);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_>
+BenchmarkThreadScalingPoint benchmark_thread_scaling_point(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    int num_threads)
+{
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    std::vector<BenchmarkAccessTiming> timings(num_threads);
+    tatami::Options opt;
+
+    auto start = std::chrono::steady_clock::now();
+    tatami::parallelize([&](size_t t, size_t start, size_t length) -> void {
+        timings[t] = benchmark_access_extractor<use_oracle_, sparse_>(matrix, sequence.data() + start, length, options, nsecondary, opt);
+    }, sequence.size(), num_threads);
+    auto end = std::chrono::steady_clock::now();
+
+    BenchmarkThreadScalingPoint output;
+    output.num_threads = num_threads;
+    output.seconds = std::chrono::duration<double>(end - start).count();
+    for (const auto& timing : timings) {
+        output.fetches += timing.fetches;
+        output.elements += timing.elements;
+        output.used_threads += (timing.fetches > 0);
+    }
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+std::vector<BenchmarkThreadScalingPoint> benchmark_thread_scaling(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkThreadScalingOptions& scaling_options)
+{
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    std::vector<BenchmarkThreadScalingPoint> output;
+    output.reserve(scaling_options.num_threads.size());
+
+    for (auto nthreads : scaling_options.num_threads) {
+        nthreads = std::max(nthreads, 1);
+        output.push_back(repeat_fastest_timing(scaling_options.repeats, [&]() -> BenchmarkThreadScalingPoint {
+            if (scaling_options.sparse) {
+                return benchmark_thread_scaling_point<use_oracle_, true>(matrix, sequence, options, nthreads);
+            } else {
+                return benchmark_thread_scaling_point<use_oracle_, false>(matrix, sequence, options, nthreads);
+            }
+        }));
+    }
+
+    if (!output.empty()) {
+        const auto& base = output.front();
+        auto per_thread = [](const BenchmarkThreadScalingPoint& point) -> double {
+            return (point.used_threads > 0 ? point.fetches_per_second() / point.used_threads : 0);
+        };
+        double base_per_thread = per_thread(base);
+        for (auto& point : output) {
+            point.efficiency = (base_per_thread > 0 ? per_thread(point) / base_per_thread : 0);
+        }
+    }
+
+    return output;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Benchmark the throughput of extraction from the full extent of each row/column for different numbers of threads.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * For each number of threads, the access sequence is split into contiguous intervals via `tatami::parallelize()`, and each thread creates its own extractor to process its interval.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param options Further options for the access pattern.
+ * @param scaling_options Options for the numbers of threads.
+ *
+ * @return Throughput and parallel efficiency for each number of threads, in the same order as `BenchmarkThreadScalingOptions::num_threads`.
+ */
+template<typename Value_, typename Index_>
+std::vector<BenchmarkThreadScalingPoint> benchmark_thread_scaling(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkThreadScalingOptions& scaling_options)
+{
+    if (options.use_oracle) {
+        return internal::benchmark_thread_scaling<true>(matrix, options, scaling_options);
+    } else {
+        return internal::benchmark_thread_scaling<false>(matrix, options, scaling_options);
+    }
+}
+
+/**
+ * Write the results of `benchmark_thread_scaling()` in CSV format, with a header line followed by one line per number of threads.
+ * The columns are `num_threads`, `used_threads`, `fetches`, `elements`, `seconds`, `fetches_per_second`, `elements_per_second` and `efficiency`.
+ *
+ * @param results Results of `benchmark_thread_scaling()`.
+ * @param output Output stream, e.g., `std::cout` or a `std::ofstream`.
+ */
+inline void write_thread_scaling_csv(const std::vector<BenchmarkThreadScalingPoint>& results, std::ostream& output) {
+    output << "num_threads,used_threads,fetches,elements,seconds,fetches_per_second,elements_per_second,efficiency\n";
+    for (const auto& point : results) {
+        output << point.num_threads << ","
+            << point.used_threads << ","
+            << point.fetches << ","
+            << point.elements << ","
+            << point.seconds << ","
+            << point.fetches_per_second() << ","
+            << point.elements_per_second() << ","
+            << point.efficiency << "\n";
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef TATAMI_TEST_BENCHMARK_UNSORTED_ACCESS_HPP
+#define TATAMI_TEST_BENCHMARK_UNSORTED_ACCESS_HPP
+
+#include "tatami/base/Matrix.hpp"
+
+#include "benchmark_access.hpp"
+#include "access_sequence.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <cstddef>
+
+/**
+ * @file benchmark_unsorted_access.hpp
+ * @brief Compare the speed of ordered and unordered sparse access on a `tatami::Matrix`.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Results of `benchmark_unsorted_full_access()` and friends.
+ */
+struct BenchmarkUnsortedAccessResult {
+    /**
+     * Timing for sparse extraction with `tatami::Options::sparse_ordered_index = true`.
+     */
+    BenchmarkAccessTiming ordered;
+
+    /**
+     * Timing for sparse extraction with `tatami::Options::sparse_ordered_index = false`.
+     */
+    BenchmarkAccessTiming unordered;
+
+    /**
+     * @return Ratio of the time spent in unordered extraction to that of ordered extraction.
+     * Values greater than 1 indicate that unordered extraction is slower.
+     * This is set to zero if no time was spent in ordered extraction.
+     */
+    double ratio() const {
+        return (ordered.seconds > 0 ? unordered.seconds / ordered.seconds : 0);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_access_base(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options,
+    Index_ extent,
+    Args_... args)
+{
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    BenchmarkUnsortedAccessResult output;
+
+    tatami::Options ordered_opt, unordered_opt;
+    unordered_opt.sparse_ordered_index = false;
+
+    // Alternating between ordered and unordered extraction and taking the fastest of each,
+    // so that transient noise or warm-up effects don't masquerade as a difference between the two.
+    // The first extraction in each repeat also alternates, so that neither is consistently favored by its position.
+    for (int r = 0, nrep = std::max(benchmark_options.repeats, 1); r < nrep; ++r) {
+        bool first = (r == 0);
+        if (r % 2 == 0) {
+            keep_fastest_timing(output.ordered, benchmark_access_extractor<use_oracle_, true>(matrix, sequence, options, extent, ordered_opt, args...), first);
+            keep_fastest_timing(output.unordered, benchmark_access_extractor<use_oracle_, true>(matrix, sequence, options, extent, unordered_opt, args...), first);
+        } else {
+            keep_fastest_timing(output.unordered, benchmark_access_extractor<use_oracle_, true>(matrix, sequence, options, extent, unordered_opt, args...), first);
+            keep_fastest_timing(output.ordered, benchmark_access_extractor<use_oracle_, true>(matrix, sequence, options, extent, ordered_opt, args...), first);
+        }
+    }
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_full_access(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, const BenchmarkAccessOptions& benchmark_options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return benchmark_unsorted_access_base<use_oracle_>(matrix, options, benchmark_options, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_block_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options)
+{
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return benchmark_unsorted_access_base<use_oracle_>(matrix, options, benchmark_options, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_indexed_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options)
+{
+    auto index_ptr = create_test_unsorted_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return benchmark_unsorted_access_base<use_oracle_>(matrix, options, benchmark_options, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Benchmark ordered and unordered sparse access to the full extent of each row/column.
+ * Rows/columns are accessed in the same order as in `test_unsorted_full_access()` with the same `options`.
+ * Each timing is the fastest of `BenchmarkAccessOptions::repeats` alternating runs of ordered and unordered extraction.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * This may be a delayed operation on top of a `ReversedIndicesWrapper`, to check that the delayed operation does not needlessly sort unordered output from its seed.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for ordered and unordered extraction.
+ */
+template<typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_full_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_unsorted_full_access<true>(matrix, options, benchmark_options);
+    } else {
+        return internal::benchmark_unsorted_full_access<false>(matrix, options, benchmark_options);
+    }
+}
+
+/**
+ * Benchmark ordered and unordered sparse access to a contiguous block of each row/column.
+ * Rows/columns are accessed in the same order as in `test_unsorted_block_access()` with the same `options`.
+ * Each timing is the fastest of `BenchmarkAccessOptions::repeats` alternating runs of ordered and unordered extraction.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for ordered and unordered extraction.
+ */
+template<typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_block_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double relative_length,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_unsorted_block_access<true>(matrix, relative_start, relative_length, options, benchmark_options);
+    } else {
+        return internal::benchmark_unsorted_block_access<false>(matrix, relative_start, relative_length, options, benchmark_options);
+    }
+}
+
+/**
+ * Benchmark ordered and unordered sparse access to an indexed subset of each row/column.
+ * Rows/columns are accessed in the same order as in `test_unsorted_indexed_access()` with the same `options`, using the same indexed subset.
+ * Each timing is the fastest of `BenchmarkAccessOptions::repeats` alternating runs of ordered and unordered extraction.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to benchmark access.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for benchmarking.
+ * @param benchmark_options Options for the number of repeats.
+ *
+ * @return Timings for ordered and unordered extraction.
+ */
+template<typename Value_, typename Index_>
+BenchmarkUnsortedAccessResult benchmark_unsorted_indexed_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    double relative_start,
+    double probability,
+    const TestAccessOptions& options,
+    const BenchmarkAccessOptions& benchmark_options = BenchmarkAccessOptions())
+{
+    if (options.use_oracle) {
+        return internal::benchmark_unsorted_indexed_access<true>(matrix, relative_start, probability, options, benchmark_options);
+    } else {
+        return internal::benchmark_unsorted_indexed_access<false>(matrix, relative_start, probability, options, benchmark_options);
+    }
+}
+
+/**
+ * Check that unordered sparse extraction is not materially slower than ordered extraction.
+ * If it is, this suggests that the matrix (or its seed) is sorting the output anyway or performing unnecessary copies.
+ *
+ * @param result Result of `benchmark_unsorted_full_access()` or friends.
+ * @param tolerance Maximum acceptable value of `BenchmarkUnsortedAccessResult::ratio()`.
+ * Values greater than 1 allow for some noise in the timings.
+ * @param fail Whether to raise a GoogleTest error if the ratio exceeds `tolerance`.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether the ratio is no greater than `tolerance`.
+ */
+inline bool check_unsorted_access_ratio(const BenchmarkUnsortedAccessResult& result, double tolerance = 1.2, bool fail = true) {
+    double ratio = result.ratio();
+    if (ratio <= tolerance) {
+        return true;
+    }
+
+    std::ostringstream msg;
+    msg << "unordered sparse extraction is " << ratio << "x slower than ordered extraction (tolerance of " << tolerance << ")";
+    internal::report_check_failure(fail, msg.str());
+    return false;
+}
+
+}
+
+#endif
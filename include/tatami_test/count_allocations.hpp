@@ -0,0 +1,570 @@
+#ifndef TATAMI_TEST_COUNT_ALLOCATIONS_HPP
+#define TATAMI_TEST_COUNT_ALLOCATIONS_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/new_extractor.hpp"
+
+#include "access_sequence.hpp"
+#include "report_check_failure.hpp"
+
+#include <new>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+
+/**
+ * @file count_allocations.hpp
+ * @brief Count heap allocations during extraction from a `tatami::Matrix`.
+ *
+ * Allocations are only counted if the global allocation functions are replaced by the versions in this header.
+ * This is achieved by defining the `TATAMI_TEST_DEFINE_ALLOCATION_HOOKS` macro before including this header in exactly one translation unit of the test executable.
+ * Otherwise, all counts are reported as zero and `allocation_tracking_enabled()` returns false.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Heap allocation counts.
+ */
+struct AllocationCounts {
+    /**
+     * Number of calls to `operator new`.
+     */
+    size_t count = 0;
+
+    /**
+     * Total number of bytes requested from `operator new`.
+     */
+    size_t bytes = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline thread_local AllocationCounts allocation_counter;
+
+inline std::atomic<bool> allocation_hooks_installed{false};
+
+inline std::atomic<size_t> allocation_global_count{0};
+
+inline std::atomic<size_t> allocation_global_bytes{0};
+
+inline std::atomic<size_t> allocation_live_bytes{0};
+
+inline std::atomic<size_t> allocation_peak_bytes{0};
+
+inline void record_allocation(size_t n) {
+    ++allocation_counter.count;
+    allocation_counter.bytes += n;
+    allocation_global_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_global_bytes.fetch_add(n, std::memory_order_relaxed);
+
+    size_t live = (allocation_live_bytes += n);
+    size_t peak = allocation_peak_bytes.load();
+    while (live > peak && !allocation_peak_bytes.compare_exchange_weak(peak, live)) {}
+}
+
+inline void record_deallocation(size_t n) {
+    allocation_live_bytes -= n;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @return Whether the allocation hooks have been installed, see `TATAMI_TEST_DEFINE_ALLOCATION_HOOKS`.
+ */
+inline bool allocation_tracking_enabled() {
+    return internal::allocation_hooks_installed.load();
+}
+
+/**
+ * @return Cumulative allocation counts for the current thread.
+ * Differences between two calls can be used to determine the number of allocations in the intervening code.
+ */
+inline AllocationCounts current_allocations() {
+    return internal::allocation_counter;
+}
+
+/**
+ * @return Cumulative allocation counts across all threads.
+ * Unlike `current_allocations()`, this includes allocations by any helper threads that are started by the intervening code,
+ * but it will also include allocations by unrelated threads that are running concurrently.
+ */
+inline AllocationCounts global_allocations() {
+    AllocationCounts output;
+    output.count = internal::allocation_global_count.load(std::memory_order_relaxed);
+    output.bytes = internal::allocation_global_bytes.load(std::memory_order_relaxed);
+    return output;
+}
+
+/**
+ * @return Number of bytes that are currently allocated with `operator new` across all threads.
+ * This is always zero if `allocation_tracking_enabled()` is false.
+ */
+inline size_t current_live_bytes() {
+    return internal::allocation_live_bytes.load();
+}
+
+/**
+ * @return Peak number of bytes allocated with `operator new` across all threads, since the last call to `reset_peak_live_bytes()`.
+ * This is always zero if `allocation_tracking_enabled()` is false.
+ */
+inline size_t peak_live_bytes() {
+    return internal::allocation_peak_bytes.load();
+}
+
+/**
+ * Reset the peak number of allocated bytes to the current number of live bytes.
+ */
+inline void reset_peak_live_bytes() {
+    internal::allocation_peak_bytes.store(internal::allocation_live_bytes.load());
+}
+
+/**
+ * @brief Allocation statistics for a single extractor in `count_full_allocations()` and friends.
+ */
+struct AllocationStatistics {
+    /**
+     * Number of allocations during construction of the extractor (and its oracle, if any).
+     */
+    AllocationCounts construction;
+
+    /**
+     * Number of calls to `fetch()`.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Allocations across all `fetch()` calls.
+     */
+    AllocationCounts total;
+
+    /**
+     * Allocations across all `fetch()` calls after the warm-up period.
+     */
+    AllocationCounts steady;
+
+    /**
+     * @return Average number of allocations per `fetch()` call.
+     */
+    double allocations_per_fetch() const {
+        return (fetches ? static_cast<double>(total.count) / fetches : 0);
+    }
+
+    /**
+     * @return Average number of allocated bytes per `fetch()` call.
+     */
+    double bytes_per_fetch() const {
+        return (fetches ? static_cast<double>(total.bytes) / fetches : 0);
+    }
+};
+
+/**
+ * @brief Results of `count_full_allocations()` and friends.
+ *
+ * Each member corresponds to one of the extractors that are tested in `test_full_access()` and friends.
+ */
+struct AllocationAccessResult {
+    /**
+     * Statistics for dense extraction.
+     */
+    AllocationStatistics dense;
+
+    /**
+     * Statistics for sparse extraction of both values and indices.
+     */
+    AllocationStatistics sparse;
+
+    /**
+     * Statistics for sparse extraction of indices only.
+     */
+    AllocationStatistics sparse_index;
+
+    /**
+     * Statistics for sparse extraction of values only.
+     */
+    AllocationStatistics sparse_value;
+
+    /**
+     * Statistics for sparse extraction of the number of non-zeros only.
+     */
+    AllocationStatistics sparse_count;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline AllocationCounts allocation_difference(const AllocationCounts& before, const AllocationCounts& after) {
+    AllocationCounts output;
+    output.count = after.count - before.count;
+    output.bytes = after.bytes - before.bytes;
+    return output;
+}
+
+inline void allocation_accumulate(AllocationCounts& target, const AllocationCounts& delta) {
+    target.count += delta.count;
+    target.bytes += delta.bytes;
+}
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+AllocationStatistics count_allocations_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    size_t warmup,
+    Index_ extent,
+    const tatami::Options& opt,
+    Args_... args)
+{
+    // Allocating the buffers before we start counting.
+    std::vector<Value_> vbuffer(extent);
+    std::vector<Index_> ibuffer(extent);
+    AllocationStatistics output;
+
+    // Using the global counts so that allocations in any helper threads of the extractor are included.
+    auto before_construction = global_allocations();
+    auto oracle = create_oracle<use_oracle_>(sequence, options);
+    auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+    output.construction = allocation_difference(before_construction, global_allocations());
+
+    output.fetches = sequence.size();
+    auto vptr = (!sparse_ || opt.sparse_extract_value ? vbuffer.data() : NULL);
+    auto iptr = (opt.sparse_extract_index ? ibuffer.data() : NULL);
+
+    for (size_t s = 0, end = sequence.size(); s < end; ++s) {
+        auto before = global_allocations();
+        if constexpr(sparse_) {
+            if constexpr(use_oracle_) {
+                ext->fetch(vptr, iptr);
+            } else {
+                ext->fetch(sequence[s], vptr, iptr);
+            }
+        } else {
+            if constexpr(use_oracle_) {
+                ext->fetch(vptr);
+            } else {
+                ext->fetch(sequence[s], vptr);
+            }
+        }
+
+        auto delta = allocation_difference(before, global_allocations());
+        allocation_accumulate(output.total, delta);
+        if (s >= warmup) {
+            allocation_accumulate(output.steady, delta);
+        }
+    }
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+AllocationAccessResult count_allocations_base(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, size_t warmup, Index_ extent, Args_... args) {
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    AllocationAccessResult output;
+
+    for_each_extractor_kind(output, [&](auto sparse, const tatami::Options& opt, AllocationStatistics& target) -> void {
+        target = count_allocations_extractor<use_oracle_, decltype(sparse)::value>(matrix, sequence, options, warmup, extent, opt, args...);
+    });
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+AllocationAccessResult count_full_allocations(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, size_t warmup) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return count_allocations_base<use_oracle_>(matrix, options, warmup, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+AllocationAccessResult count_block_allocations(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options, size_t warmup) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return count_allocations_base<use_oracle_>(matrix, options, warmup, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+AllocationAccessResult count_indexed_allocations(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options, size_t warmup) {
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return count_allocations_base<use_oracle_>(matrix, options, warmup, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Count heap allocations during extraction of the full extent of each row/column.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to count allocations.
+ * @param options Further options for the access pattern.
+ * @param warmup Number of `fetch()` calls in the warm-up period, during which allocations are not included in `AllocationStatistics::steady`.
+ * This allows extractors to lazily allocate their workspaces.
+ *
+ * Allocations are counted across all threads via `global_allocations()`, so that allocations by any helper threads of the extractor are included.
+ * As a result, no other threads should allocate while this function is running.
+ *
+ * @return Allocation statistics for each type of extractor.
+ * All counts are zero if `allocation_tracking_enabled()` is false.
+ */
+template<typename Value_, typename Index_>
+AllocationAccessResult count_full_allocations(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, size_t warmup = 2) {
+    if (options.use_oracle) {
+        return internal::count_full_allocations<true>(matrix, options, warmup);
+    } else {
+        return internal::count_full_allocations<false>(matrix, options, warmup);
+    }
+}
+
+/**
+ * Count heap allocations during extraction of a contiguous block of each row/column.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to count allocations.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for the access pattern.
+ * @param warmup Number of `fetch()` calls in the warm-up period, see `count_full_allocations()`.
+ *
+ * @return Allocation statistics for each type of extractor.
+ * All counts are zero if `allocation_tracking_enabled()` is false.
+ */
+template<typename Value_, typename Index_>
+AllocationAccessResult count_block_allocations(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options, size_t warmup = 2) {
+    if (options.use_oracle) {
+        return internal::count_block_allocations<true>(matrix, relative_start, relative_length, options, warmup);
+    } else {
+        return internal::count_block_allocations<false>(matrix, relative_start, relative_length, options, warmup);
+    }
+}
+
+/**
+ * Count heap allocations during extraction of an indexed subset of each row/column.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`, using the same indexed subset.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to count allocations.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for the access pattern.
+ * @param warmup Number of `fetch()` calls in the warm-up period, see `count_full_allocations()`.
+ *
+ * @return Allocation statistics for each type of extractor.
+ * All counts are zero if `allocation_tracking_enabled()` is false.
+ */
+template<typename Value_, typename Index_>
+AllocationAccessResult count_indexed_allocations(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options, size_t warmup = 2) {
+    if (options.use_oracle) {
+        return internal::count_indexed_allocations<true>(matrix, relative_start, probability, options, warmup);
+    } else {
+        return internal::count_indexed_allocations<false>(matrix, relative_start, probability, options, warmup);
+    }
+}
+
+/**
+ * Check that no extractor allocates after its warm-up period.
+ *
+ * @param result Result of `count_full_allocations()` or friends.
+ * @param fail Whether to raise a GoogleTest error if any extractor allocates after its warm-up period.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether all extractors are free of allocations after their warm-up period.
+ */
+inline bool check_steady_state_allocations(const AllocationAccessResult& result, bool fail = true) {
+    std::ostringstream msg;
+    bool okay = true;
+
+    auto check = [&](const AllocationStatistics& stats, const char* name) -> void {
+        if (stats.steady.count == 0) {
+            return;
+        }
+        msg << "\n  " << name << " extraction made " << stats.steady.count << " allocation(s) (" << stats.steady.bytes << " bytes) after warm-up";
+        okay = false;
+    };
+
+    check(result.dense, "dense");
+    check(result.sparse, "sparse");
+    check(result.sparse_index, "index-only sparse");
+    check(result.sparse_value, "value-only sparse");
+    check(result.sparse_count, "count-only sparse");
+    if (okay) {
+        return true;
+    }
+
+    internal::report_check_failure(fail, "heap allocations in steady-state fetch() calls:" + msg.str());
+    return false;
+}
+
+}
+
+#endif
+
+// Defined outside of the include guard, so that the hooks can be defined even if this header was previously included without the macro.
+#if defined(TATAMI_TEST_DEFINE_ALLOCATION_HOOKS) && !defined(TATAMI_TEST_ALLOCATION_HOOKS_DEFINED)
+#define TATAMI_TEST_ALLOCATION_HOOKS_DEFINED
+
+/**
+ * @cond
+ */
+namespace tatami_test {
+
+namespace internal {
+
+inline const bool allocation_hooks_installer = (allocation_hooks_installed = true);
+
+// Each allocation is prefixed with a header that stores its size, so that we can track the live bytes upon deallocation.
+inline constexpr size_t allocation_header = alignof(std::max_align_t);
+
+inline void* allocate_tracked_base(std::size_t n, size_t offset, size_t alignment) {
+    size_t total = n + offset;
+    void* base = (alignment ? std::aligned_alloc(alignment, (total + alignment - 1) / alignment * alignment) : std::malloc(total));
+    if (base == NULL) {
+        throw std::bad_alloc();
+    }
+
+    record_allocation(n);
+    char* ptr = static_cast<char*>(base) + offset;
+    std::memcpy(ptr - sizeof(size_t), &n, sizeof(size_t));
+    return ptr;
+}
+
+inline void deallocate_tracked_base(void* ptr, size_t offset) {
+    if (ptr == NULL) {
+        return;
+    }
+    char* cptr = static_cast<char*>(ptr);
+    size_t n;
+    std::memcpy(&n, cptr - sizeof(size_t), sizeof(size_t));
+    record_deallocation(n);
+    std::free(cptr - offset);
+}
+
+inline void* allocate_tracked(std::size_t n) {
+    return allocate_tracked_base(n, allocation_header, 0);
+}
+
+inline void deallocate_tracked(void* ptr) {
+    deallocate_tracked_base(ptr, allocation_header);
+}
+
+inline size_t aligned_allocation_offset(std::align_val_t al) {
+    return std::max(static_cast<size_t>(al), allocation_header);
+}
+
+inline void* allocate_tracked_aligned(std::size_t n, std::align_val_t al) {
+    return allocate_tracked_base(n, aligned_allocation_offset(al), static_cast<size_t>(al));
+}
+
+inline void deallocate_tracked_aligned(void* ptr, std::align_val_t al) {
+    deallocate_tracked_base(ptr, aligned_allocation_offset(al));
+}
+
+}
+
+}
+
+void* operator new(std::size_t n) {
+    return tatami_test::internal::allocate_tracked(n);
+}
+
+void* operator new[](std::size_t n) {
+    return tatami_test::internal::allocate_tracked(n);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    try {
+        return tatami_test::internal::allocate_tracked(n);
+    } catch (...) {
+        return NULL;
+    }
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    try {
+        return tatami_test::internal::allocate_tracked(n);
+    } catch (...) {
+        return NULL;
+    }
+}
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    return tatami_test::internal::allocate_tracked_aligned(n, al);
+}
+
+void* operator new[](std::size_t n, std::align_val_t al) {
+    return tatami_test::internal::allocate_tracked_aligned(n, al);
+}
+
+void operator delete(void* ptr) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    tatami_test::internal::deallocate_tracked(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t al) noexcept {
+    tatami_test::internal::deallocate_tracked_aligned(ptr, al);
+}
+
+void operator delete[](void* ptr, std::align_val_t al) noexcept {
+    tatami_test::internal::deallocate_tracked_aligned(ptr, al);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t al) noexcept {
+    tatami_test::internal::deallocate_tracked_aligned(ptr, al);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t al) noexcept {
+    tatami_test::internal::deallocate_tracked_aligned(ptr, al);
+}
+/**
+ * @endcond
+ */
+
+#endif
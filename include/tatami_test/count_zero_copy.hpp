@@ -0,0 +1,259 @@
+#ifndef TATAMI_TEST_COUNT_ZERO_COPY_HPP
+#define TATAMI_TEST_COUNT_ZERO_COPY_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/new_extractor.hpp"
+
+#include "access_sequence.hpp"
+#include "fetch.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+ * @file count_zero_copy.hpp
+ * @brief Count the `fetch()` calls that return a pointer to the extractor's internal storage.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Zero-copy statistics for a single extractor in `count_full_zero_copy()` and friends.
+ */
+struct ZeroCopyStatistics {
+    /**
+     * Number of calls to `fetch()`.
+     */
+    size_t fetches = 0;
+
+    /**
+     * Number of `fetch()` calls that returned a pointer to the extractor's internal storage, i.e., without copying into the supplied buffer.
+     * For sparse extraction, a call is only considered to be zero-copy if none of the requested values or indices were copied into the supplied buffers.
+     */
+    size_t zero_copy = 0;
+
+    /**
+     * @return Proportion of `fetch()` calls that were zero-copy.
+     */
+    double fraction() const {
+        return (fetches ? static_cast<double>(zero_copy) / fetches : 0);
+    }
+};
+
+/**
+ * @brief Results of `count_full_zero_copy()` and friends.
+ *
+ * Each member corresponds to one of the extractors that are tested in `test_full_access()` and friends.
+ * Sparse extraction of the number of non-zeros only is omitted as no pointers are returned.
+ */
+struct ZeroCopyResult {
+    /**
+     * Statistics for dense extraction.
+     */
+    ZeroCopyStatistics dense;
+
+    /**
+     * Statistics for sparse extraction of both values and indices.
+     */
+    ZeroCopyStatistics sparse;
+
+    /**
+     * Statistics for sparse extraction of indices only.
+     */
+    ZeroCopyStatistics sparse_index;
+
+    /**
+     * Statistics for sparse extraction of values only.
+     */
+    ZeroCopyStatistics sparse_value;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+ZeroCopyStatistics count_zero_copy_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    Index_ extent,
+    const tatami::Options& opt,
+    Args_... args)
+{
+    auto oracle = create_oracle<use_oracle_>(sequence, options);
+    auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+    std::vector<Value_> vbuffer(extent);
+    std::vector<Index_> ibuffer(extent);
+
+    ZeroCopyStatistics output;
+    output.fetches = sequence.size();
+
+    if constexpr(sparse_) {
+        auto vptr = (opt.sparse_extract_value ? vbuffer.data() : NULL);
+        auto iptr = (opt.sparse_extract_index ? ibuffer.data() : NULL);
+        for (auto i : sequence) {
+            auto range = [&]() {
+                if constexpr(use_oracle_) {
+                    return ext->fetch(vptr, iptr);
+                } else {
+                    return ext->fetch(i, vptr, iptr);
+                }
+            }();
+            output.zero_copy += returned_own_pointer(range, vptr, iptr);
+        }
+    } else {
+        auto vptr = vbuffer.data();
+        for (auto i : sequence) {
+            auto ptr = [&]() {
+                if constexpr(use_oracle_) {
+                    return ext->fetch(vptr);
+                } else {
+                    return ext->fetch(i, vptr);
+                }
+            }();
+            output.zero_copy += returned_own_pointer(ptr, vptr);
+        }
+    }
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+ZeroCopyResult count_zero_copy_base(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, Index_ extent, Args_... args) {
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    ZeroCopyResult output;
+
+    for_each_extractor_kind(output, [&](auto sparse, const tatami::Options& opt, ZeroCopyStatistics& target) -> void {
+        target = count_zero_copy_extractor<use_oracle_, decltype(sparse)::value>(matrix, sequence, options, extent, opt, args...);
+    });
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+ZeroCopyResult count_full_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return count_zero_copy_base<use_oracle_>(matrix, options, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+ZeroCopyResult count_block_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return count_zero_copy_base<use_oracle_>(matrix, options, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+ZeroCopyResult count_indexed_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options) {
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return count_zero_copy_base<use_oracle_>(matrix, options, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Count the number of `fetch()` calls that return a pointer to the extractor's internal storage during extraction of the full extent of each row/column.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix to be inspected.
+ * @param options Further options for the access pattern.
+ *
+ * @return Zero-copy statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+ZeroCopyResult count_full_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::count_full_zero_copy<true>(matrix, options);
+    } else {
+        return internal::count_full_zero_copy<false>(matrix, options);
+    }
+}
+
+/**
+ * Count the number of `fetch()` calls that return a pointer to the extractor's internal storage during extraction of a contiguous block of each row/column.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix to be inspected.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for the access pattern.
+ *
+ * @return Zero-copy statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+ZeroCopyResult count_block_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::count_block_zero_copy<true>(matrix, relative_start, relative_length, options);
+    } else {
+        return internal::count_block_zero_copy<false>(matrix, relative_start, relative_length, options);
+    }
+}
+
+/**
+ * Count the number of `fetch()` calls that return a pointer to the extractor's internal storage during extraction of an indexed subset of each row/column.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`, using the same indexed subset.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix to be inspected.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for the access pattern.
+ *
+ * @return Zero-copy statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+ZeroCopyResult count_indexed_zero_copy(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::count_indexed_zero_copy<true>(matrix, relative_start, probability, options);
+    } else {
+        return internal::count_indexed_zero_copy<false>(matrix, relative_start, probability, options);
+    }
+}
+
+/**
+ * Check that an extractor returns a pointer to its internal storage for a minimum proportion of `fetch()` calls.
+ * This is typically used to check that a cheap zero-copy path (e.g., row access to a row-major `tatami::DenseMatrix`) is preserved by wrappers or delayed operations.
+ *
+ * @param stats Statistics for a single extractor, typically a member of the result of `count_full_zero_copy()` or friends.
+ * @param min_fraction Minimum acceptable proportion of zero-copy `fetch()` calls.
+ * @param fail Whether to raise a GoogleTest error if the proportion of zero-copy calls is below `min_fraction`.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether the proportion of zero-copy calls is at least `min_fraction`.
+ */
+inline bool check_zero_copy(const ZeroCopyStatistics& stats, double min_fraction = 1, bool fail = true) {
+    if (stats.fetches == 0 || stats.fraction() >= min_fraction) {
+        return true;
+    }
+
+    internal::report_check_failure(fail, "only " + std::to_string(stats.zero_copy) + " out of " + std::to_string(stats.fetches) + " fetches were zero-copy");
+    return false;
+}
+
+}
+
+#endif
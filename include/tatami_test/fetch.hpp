@@ -27,6 +27,19 @@ void trim_sparse(const tatami::SparseRange<Value_, Index_>& raw, std::vector<Val
     output_i.resize(raw.number);
 }
 
+// Whether a fetch() call returned a pointer to the extractor's own storage, i.e., without copying into the supplied buffer.
+// For sparse extraction, this only holds if neither of the requested values or indices were copied into their buffers;
+// a NULL buffer means that the corresponding array was not requested and is ignored.
+template<typename Value_>
+bool returned_own_pointer(const Value_* ptr, const Value_* buffer) {
+    return ptr != buffer;
+}
+
+template<typename Value_, typename Index_>
+bool returned_own_pointer(const tatami::SparseRange<Value_, Index_>& range, const Value_* vbuffer, const Index_* ibuffer) {
+    return (!vbuffer || range.value != vbuffer) && (!ibuffer || range.index != ibuffer);
+}
+
 }
 /**
  * @endcond
@@ -77,6 +90,8 @@ struct SparseVector {
     /**
      * @cond
      */
+    SparseVector() = default;
+
     SparseVector(size_t n) : value(n), index(n) {}
     /**
      * @endcond
@@ -129,6 +144,88 @@ SparseVector<Value_, Index_> fetch(tatami::OracularSparseExtractor<Value_, Index
     return output;
 }
 
+/**
+ * Overload of `fetch()` that reuses a caller-owned buffer.
+ * No allocations are performed once the capacity of `output` is at least `number`, making this suitable for repeated calls in tight loops.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param ext An extractor object.
+ * @param i Row/column index to extract.
+ * @param number Number of elements to extract along the non-target dimension.
+ * @param[out] output Vector in which to store the extracted values from row/column `i`.
+ * On output, this has length equal to `number`.
+ */
+template<typename Value_, typename Index_>
+void fetch(tatami::MyopicDenseExtractor<Value_, Index_>& ext, Index_ i, size_t number, std::vector<Value_>& output) {
+    output.resize(number);
+    auto raw = ext.fetch(i, output.data());
+    tatami::copy_n(raw, number, output.data());
+}
+
+/**
+ * Overload of `fetch()` that reuses a caller-owned buffer.
+ * No allocations are performed once the capacity of `output` is at least `number`, making this suitable for repeated calls in tight loops.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param ext An extractor object.
+ * @param number Number of elements to extract along the non-target dimension.
+ * @param[out] output Vector in which to store the extracted values from the next row/column.
+ * On output, this has length equal to `number`.
+ */
+template<typename Value_, typename Index_>
+void fetch(tatami::OracularDenseExtractor<Value_, Index_>& ext, size_t number, std::vector<Value_>& output) {
+    output.resize(number);
+    auto raw = ext.fetch(output.data());
+    tatami::copy_n(raw, number, output.data());
+}
+
+/**
+ * Overload of `fetch()` that reuses a caller-owned sparse vector.
+ * No allocations are performed once the capacities of `output.value` and `output.index` are at least `number`, making this suitable for repeated calls in tight loops.
+ * Note that both vectors are resized to `number` before extraction, so any elements beyond the number of non-zeros from the previous call are value-initialized;
+ * each call still incurs an `O(number)` cost in addition to the extraction itself.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param ext An extractor object.
+ * @param i Row/column index to extract.
+ * @param number Number of elements to extract along the non-target dimension.
+ * @param[out] output Sparse vector in which to store up to `number` extracted values from row/column `i`.
+ */
+template<typename Value_, typename Index_>
+void fetch(tatami::MyopicSparseExtractor<Value_, Index_>& ext, Index_ i, size_t number, SparseVector<Value_, Index_>& output) {
+    output.value.resize(number);
+    output.index.resize(number);
+    auto raw = ext.fetch(i, output.value.data(), output.index.data());
+    internal::trim_sparse(raw, output.value, output.index);
+}
+
+/**
+ * Overload of `fetch()` that reuses a caller-owned sparse vector.
+ * No allocations are performed once the capacities of `output.value` and `output.index` are at least `number`, making this suitable for repeated calls in tight loops.
+ * Note that both vectors are resized to `number` before extraction, so any elements beyond the number of non-zeros from the previous call are value-initialized;
+ * each call still incurs an `O(number)` cost in addition to the extraction itself.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param ext An extractor object.
+ * @param number Number of elements to extract along the non-target dimension.
+ * @param[out] output Sparse vector in which to store up to `number` extracted values from the next row/column.
+ */
+template<typename Value_, typename Index_>
+void fetch(tatami::OracularSparseExtractor<Value_, Index_>& ext, size_t number, SparseVector<Value_, Index_>& output) {
+    output.value.resize(number);
+    output.index.resize(number);
+    auto raw = ext.fetch(output.value.data(), output.index.data());
+    internal::trim_sparse(raw, output.value, output.index);
+}
+
 }
 
 #endif
@@ -0,0 +1,319 @@
+#ifndef TATAMI_TEST_MEASURE_MEMORY_HPP
+#define TATAMI_TEST_MEASURE_MEMORY_HPP
+
+#include "tatami/base/Matrix.hpp"
+#include "tatami/utils/new_extractor.hpp"
+
+#include "count_allocations.hpp"
+#include "access_sequence.hpp"
+#include "report_check_failure.hpp"
+
+#include <vector>
+#include <sstream>
+#include <cstddef>
+
+/**
+ * @file measure_memory.hpp
+ * @brief Measure peak heap memory usage during extraction from a `tatami::Matrix`.
+ *
+ * This relies on the allocation hooks in `count_allocations.hpp`, see the `TATAMI_TEST_DEFINE_ALLOCATION_HOOKS` macro.
+ * If the hooks are not installed, all measurements are reported as zero.
+ * As the live bytes are tracked across all threads, measurements should not be performed while other threads are allocating.
+ */
+
+namespace tatami_test {
+
+/**
+ * Measure the peak heap memory usage of an arbitrary function, e.g., construction of a `tatami::Matrix`.
+ *
+ * @tparam Function_ Function that accepts no arguments.
+ * @param fun Function to be executed.
+ *
+ * @return Peak number of live bytes during execution of `fun`, relative to the number of live bytes before `fun` was called.
+ */
+template<class Function_>
+size_t measure_peak_memory(Function_ fun) {
+    size_t baseline = current_live_bytes();
+    reset_peak_live_bytes();
+    fun();
+    size_t peak = peak_live_bytes();
+    return (peak > baseline ? peak - baseline : 0);
+}
+
+/**
+ * @brief Memory statistics for a single extractor in `measure_full_memory()` and friends.
+ *
+ * All values are relative to the number of live bytes before the extractor was constructed.
+ */
+struct MemoryStatistics {
+    /**
+     * Peak number of live bytes during construction of the extractor (and its oracle, if any).
+     */
+    size_t construction_peak = 0;
+
+    /**
+     * Number of live bytes after construction of the extractor, i.e., the size of the extractor and any workspaces allocated in its constructor.
+     */
+    size_t retained = 0;
+
+    /**
+     * Peak number of live bytes across construction and the full access sweep.
+     */
+    size_t peak = 0;
+
+    /**
+     * Number of live bytes remaining after destruction of the extractor.
+     * This should usually be zero, otherwise the extractor has leaked memory or added to some persistent cache.
+     */
+    size_t leaked = 0;
+};
+
+/**
+ * @brief Results of `measure_full_memory()` and friends.
+ *
+ * Each member corresponds to one of the extractors that are tested in `test_full_access()` and friends.
+ */
+struct MemoryAccessResult {
+    /**
+     * Number of bytes required to store the values and indices for a single row/column of the extracted subset,
+     * i.e., the number of elements along the non-target dimension multiplied by the sum of the sizes of the value and index types.
+     */
+    size_t extent_bytes = 0;
+
+    /**
+     * Statistics for dense extraction.
+     */
+    MemoryStatistics dense;
+
+    /**
+     * Statistics for sparse extraction of both values and indices.
+     */
+    MemoryStatistics sparse;
+
+    /**
+     * Statistics for sparse extraction of indices only.
+     */
+    MemoryStatistics sparse_index;
+
+    /**
+     * Statistics for sparse extraction of values only.
+     */
+    MemoryStatistics sparse_value;
+
+    /**
+     * Statistics for sparse extraction of the number of non-zeros only.
+     */
+    MemoryStatistics sparse_count;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline size_t memory_above(size_t value, size_t baseline) {
+    return (value > baseline ? value - baseline : 0);
+}
+
+template<bool use_oracle_, bool sparse_, typename Value_, typename Index_, typename ...Args_>
+MemoryStatistics measure_memory_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const std::vector<Index_>& sequence,
+    const TestAccessOptions& options,
+    Index_ extent,
+    const tatami::Options& opt,
+    Args_... args)
+{
+    // Allocating the buffers before we take the baseline.
+    std::vector<Value_> vbuffer(extent);
+    std::vector<Index_> ibuffer(extent);
+    auto vptr = (!sparse_ || opt.sparse_extract_value ? vbuffer.data() : NULL);
+    auto iptr = (opt.sparse_extract_index ? ibuffer.data() : NULL);
+    MemoryStatistics output;
+
+    size_t baseline = current_live_bytes();
+    reset_peak_live_bytes();
+
+    {
+        auto oracle = create_oracle<use_oracle_>(sequence, options);
+        auto ext = tatami::new_extractor<sparse_, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+        output.construction_peak = memory_above(peak_live_bytes(), baseline);
+        output.retained = memory_above(current_live_bytes(), baseline);
+
+        for (size_t s = 0, end = sequence.size(); s < end; ++s) {
+            if constexpr(sparse_) {
+                if constexpr(use_oracle_) {
+                    ext->fetch(vptr, iptr);
+                } else {
+                    ext->fetch(sequence[s], vptr, iptr);
+                }
+            } else {
+                if constexpr(use_oracle_) {
+                    ext->fetch(vptr);
+                } else {
+                    ext->fetch(sequence[s], vptr);
+                }
+            }
+        }
+
+        output.peak = memory_above(peak_live_bytes(), baseline);
+    }
+
+    output.leaked = memory_above(current_live_bytes(), baseline);
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, typename ...Args_>
+MemoryAccessResult measure_memory_base(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options, Index_ extent, Args_... args) {
+    auto sequence = simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options);
+    MemoryAccessResult output;
+    output.extent_bytes = static_cast<size_t>(extent) * (sizeof(Value_) + sizeof(Index_));
+
+    for_each_extractor_kind(output, [&](auto sparse, const tatami::Options& opt, MemoryStatistics& target) -> void {
+        target = measure_memory_extractor<use_oracle_, decltype(sparse)::value>(matrix, sequence, options, extent, opt, args...);
+    });
+
+    return output;
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+MemoryAccessResult measure_full_memory(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    return measure_memory_base<use_oracle_>(matrix, options, nsecondary);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+MemoryAccessResult measure_block_memory(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options) {
+    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
+    Index_ start = nsecondary * relative_start;
+    Index_ length = nsecondary * relative_length;
+    return measure_memory_base<use_oracle_>(matrix, options, length, start, length);
+}
+
+template<bool use_oracle_, typename Value_, typename Index_>
+MemoryAccessResult measure_indexed_memory(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options) {
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
+    Index_ num_indices = index_ptr->size();
+    return measure_memory_base<use_oracle_>(matrix, options, num_indices, std::move(index_ptr));
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Measure the peak heap memory usage of each extractor during extraction of the full extent of each row/column.
+ * Rows/columns are accessed in the same order as in `test_full_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to measure memory usage.
+ * @param options Further options for the access pattern.
+ *
+ * @return Memory statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+MemoryAccessResult measure_full_memory(const tatami::Matrix<Value_, Index_>& matrix, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::measure_full_memory<true>(matrix, options);
+    } else {
+        return internal::measure_full_memory<false>(matrix, options);
+    }
+}
+
+/**
+ * Measure the peak heap memory usage of each extractor during extraction of a contiguous block of each row/column.
+ * Rows/columns are accessed in the same order as in `test_block_access()` with the same `options`.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to measure memory usage.
+ * @param relative_start Start of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param relative_length Length of the block, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`, and the sum of `relative_start` and `relative_length` should be no greater than 1.
+ * @param options Further options for the access pattern.
+ *
+ * @return Memory statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+MemoryAccessResult measure_block_memory(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double relative_length, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::measure_block_memory<true>(matrix, relative_start, relative_length, options);
+    } else {
+        return internal::measure_block_memory<false>(matrix, relative_start, relative_length, options);
+    }
+}
+
+/**
+ * Measure the peak heap memory usage of each extractor during extraction of an indexed subset of each row/column.
+ * Rows/columns are accessed in the same order as in `test_indexed_access()` with the same `options`, using the same indexed subset.
+ * Note that `TestAccessOptions::num_threads` and `TestAccessOptions::check_sparse` are ignored.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to measure memory usage.
+ * @param relative_start Start of the indexed subset, as a proportion of the extent of the non-target dimension.
+ * This should lie in `[0, 1)`.
+ * @param probability Probability of sampling rows/columns when simulating the indexed subset.
+ * This should lie in `[0, 1]`.
+ * @param options Further options for the access pattern.
+ *
+ * @return Memory statistics for each type of extractor.
+ */
+template<typename Value_, typename Index_>
+MemoryAccessResult measure_indexed_memory(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options) {
+    if (options.use_oracle) {
+        return internal::measure_indexed_memory<true>(matrix, relative_start, probability, options);
+    } else {
+        return internal::measure_indexed_memory<false>(matrix, relative_start, probability, options);
+    }
+}
+
+/**
+ * Check that the peak memory usage of each extractor is bounded relative to the size of a single row/column.
+ * This detects extractors that buffer large parts of the matrix, e.g., an oracle-aware extractor that caches all predicted rows/columns.
+ *
+ * @param result Result of `measure_full_memory()` or friends.
+ * @param max_multiple Maximum acceptable peak memory usage, as a multiple of `MemoryAccessResult::extent_bytes`.
+ * @param slack Additional number of bytes to allow, to account for the fixed overhead of each extractor.
+ * @param fail Whether to raise a GoogleTest error if the peak memory usage of any extractor exceeds the limit.
+ * If `false` or if `TATAMI_TEST_NO_GTEST` is defined, a warning is printed to `std::cerr` instead.
+ *
+ * @return Whether the peak memory usage of all extractors is within the limit.
+ */
+inline bool check_peak_memory(const MemoryAccessResult& result, double max_multiple = 10, size_t slack = 65536, bool fail = true) {
+    double limit = max_multiple * result.extent_bytes + slack;
+    std::ostringstream msg;
+    bool okay = true;
+
+    auto check = [&](const MemoryStatistics& stats, const char* name) -> void {
+        if (stats.peak <= limit) {
+            return;
+        }
+        msg << "\n  " << name << " extraction has a peak of " << stats.peak << " bytes";
+        okay = false;
+    };
+
+    check(result.dense, "dense");
+    check(result.sparse, "sparse");
+    check(result.sparse_index, "index-only sparse");
+    check(result.sparse_value, "value-only sparse");
+    check(result.sparse_count, "count-only sparse");
+    if (okay) {
+        return true;
+    }
+
+    internal::report_check_failure(fail, "peak memory usage exceeds the limit of " + std::to_string(static_cast<size_t>(limit)) + " bytes:" + msg.str());
+    return false;
+}
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TATAMI_TEST_REPORT_CHECK_FAILURE_HPP
+#define TATAMI_TEST_REPORT_CHECK_FAILURE_HPP
+
+#ifndef TATAMI_TEST_NO_GTEST
+#include <gtest/gtest.h>
+#endif
+
+#include <string>
+#include <iostream>
+
+/**
+ * @file report_check_failure.hpp
+ * @brief Report failures from the `check_*()` functions.
+ *
+ * By default, failures are reported as GoogleTest errors if requested.
+ * If the `TATAMI_TEST_NO_GTEST` macro is defined before including any **tatami_test** header, GoogleTest is not included,
+ * and failures are always reported as warnings to `std::cerr`.
+ * This allows the benchmarking functions and their checks to be used in standalone executables that do not link to GoogleTest.
+ */
+
+namespace tatami_test {
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline void report_check_failure(bool fail, const std::string& message) {
+#ifndef TATAMI_TEST_NO_GTEST
+    if (fail) {
+        ADD_FAILURE() << message;
+        return;
+    }
+#else
+    (void)fail;
+#endif
+    std::cerr << "WARNING: " << message << std::endl;
+}
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
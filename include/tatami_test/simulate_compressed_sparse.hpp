@@ -4,6 +4,8 @@
 #include <random>
 #include <vector>
 #include <cstdint>
+#include <algorithm>
+#include <thread>
 
 /**
  * @file simulate_compressed_sparse.hpp
@@ -35,6 +37,13 @@ struct SimulateCompressedSparseOptions {
      * Seed for the PRNG.
      */
     uint64_t seed = 1234567890;
+
+    /**
+     * Whether to skip directly to the next non-zero element by sampling the gap between non-zero elements from a geometric distribution.
+     * This reduces the simulation time to be proportional to the number of non-zero elements, rather than the product of the dimension extents.
+     * Note that the simulated values for a given `SimulateCompressedSparseOptions::seed` will differ from those when `skip_ahead = false`.
+     */
+    bool skip_ahead = false;
 };
 
 /**
@@ -66,6 +75,72 @@ struct SimulateCompressedSparseResult {
     std::vector<size_t> indptr;
 };
 
+/**
+ * @cond
+ */
+namespace internal {
+
+template<typename Value_, typename Index_, class Engine_>
+void simulate_compressed_sparse_secondary(size_t secondary, const SimulateCompressedSparseOptions& options, Engine_& rng, std::vector<Value_>& data, std::vector<Index_>& index) {
+    std::uniform_real_distribution<> unif(options.lower, options.upper);
+
+    if (!options.skip_ahead) {
+        std::uniform_real_distribution<> nonzero(0.0, 1.0);
+        for (size_t s = 0; s < secondary; ++s) {
+            if (nonzero(rng) < options.density) {
+                data.push_back(unif(rng));
+                index.push_back(s);
+            }
+        }
+        return;
+    }
+
+    if (options.density <= 0) {
+        return;
+    }
+
+    if (options.density >= 1) {
+        for (size_t s = 0; s < secondary; ++s) {
+            data.push_back(unif(rng));
+            index.push_back(s);
+        }
+        return;
+    }
+
+    // Number of zeros before the next non-zero element follows a geometric distribution.
+    std::geometric_distribution<size_t> gap(options.density);
+    size_t s = 0;
+    while (1) {
+        auto skip = gap(rng);
+        if (skip >= secondary - s) {
+            break;
+        }
+        s += skip;
+        data.push_back(unif(rng));
+        index.push_back(s);
+        ++s;
+    }
+}
+
+inline uint64_t primary_seed(uint64_t seed, size_t p) {
+    // SplitMix64 finalizer, to decorrelate the seeds for adjacent primary dimension elements.
+    uint64_t z = seed + (static_cast<uint64_t>(p) + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+template<typename Value_, typename Index_>
+void simulate_compressed_sparse_primary(size_t p, size_t secondary, const SimulateCompressedSparseOptions& options, std::vector<Value_>& data, std::vector<Index_>& index) {
+    std::mt19937_64 rng(primary_seed(options.seed, p));
+    simulate_compressed_sparse_secondary(secondary, options, rng, data, index);
+}
+
+}
+/**
+ * @endcond
+ */
+
 /**
  * Simulate values in a compressed sparse matrix.
  *
@@ -81,26 +156,187 @@ struct SimulateCompressedSparseResult {
 template<typename Value_, typename Index_>
 SimulateCompressedSparseResult<Value_, Index_> simulate_compressed_sparse(size_t primary, size_t secondary, const SimulateCompressedSparseOptions& options) {
     std::mt19937_64 rng(options.seed);
-    std::uniform_real_distribution<> nonzero(0.0, 1.0);
-    std::uniform_real_distribution<> unif(options.lower, options.upper);
 
     SimulateCompressedSparseResult<Value_, Index_> output;
     output.indptr.resize(primary + 1);
+    if (options.skip_ahead) {
+        size_t expected = static_cast<double>(primary) * static_cast<double>(secondary) * std::min(std::max(options.density, 0.0), 1.0);
+        output.data.reserve(expected);
+        output.index.reserve(expected);
+    }
+
     for (size_t p = 0; p < primary; ++p) {
-        size_t idx = output.indptr[p];
-        for (size_t s = 0; s < secondary; ++s) {
-            if (nonzero(rng) < options.density) {
-                output.data.push_back(unif(rng));
-                output.index.push_back(s);
-                ++idx;
-            }
+        internal::simulate_compressed_sparse_secondary(secondary, options, rng, output.data, output.index);
+        output.indptr[p + 1] = output.index.size();
+    }
+
+    return output;
+}
+
+/**
+ * Simulate values in a compressed sparse matrix with multiple threads.
+ * Each primary dimension element is simulated from its own PRNG stream, seeded from `SimulateCompressedSparseOptions::seed` and the index of the element.
+ * This ensures that the result is the same for any `num_threads` (though it will differ from that of `simulate_compressed_sparse()` with the same seed).
+ *
+ * @tparam Value_ Type of simulated value. 
+ * @tparam Index_ Integer type for the index.
+ *
+ * @param primary Extent of the primary dimension, i.e., the dimension used to compress non-zero elements.
+ * @param secondary Extent of the secondary dimension.
+ * @param options Simulation options.
+ * @param num_threads Number of threads to use.
+ * Each thread processes a contiguous range of primary dimension elements.
+ *
+ * @return Simulated values that can be used to construct a compressed sparse matrix.
+ */
+template<typename Value_, typename Index_>
+SimulateCompressedSparseResult<Value_, Index_> simulate_compressed_sparse_parallel(size_t primary, size_t secondary, const SimulateCompressedSparseOptions& options, int num_threads) {
+    size_t nthreads = std::max(1, num_threads);
+    nthreads = std::min(nthreads, std::max(primary, static_cast<size_t>(1)));
+    size_t per_thread = primary / nthreads + (primary % nthreads > 0);
+
+    std::vector<std::vector<Value_> > chunk_data(nthreads);
+    std::vector<std::vector<Index_> > chunk_index(nthreads);
+    SimulateCompressedSparseResult<Value_, Index_> output;
+    output.indptr.resize(primary + 1);
+
+    auto run = [&](auto fun) -> void {
+        std::vector<std::thread> workers;
+        workers.reserve(nthreads - 1);
+        for (size_t t = 1; t < nthreads; ++t) {
+            workers.emplace_back(fun, t);
+        }
+        fun(0);
+        for (auto& w : workers) {
+            w.join();
         }
-        output.indptr[p + 1] = idx;
+    };
+
+    run([&](size_t t) -> void {
+        size_t start = std::min(primary, t * per_thread), end = std::min(primary, start + per_thread);
+        auto& cdata = chunk_data[t];
+        auto& cindex = chunk_index[t];
+        for (size_t p = start; p < end; ++p) {
+            internal::simulate_compressed_sparse_primary(p, secondary, options, cdata, cindex);
+            output.indptr[p + 1] = cindex.size(); // relative to the start of the chunk for now.
+        }
+    });
+
+    std::vector<size_t> offsets(nthreads + 1);
+    for (size_t t = 0; t < nthreads; ++t) {
+        offsets[t + 1] = offsets[t] + chunk_index[t].size();
     }
+    output.data.resize(offsets.back());
+    output.index.resize(offsets.back());
+
+    run([&](size_t t) -> void {
+        size_t start = std::min(primary, t * per_thread), end = std::min(primary, start + per_thread);
+        for (size_t p = start; p < end; ++p) {
+            output.indptr[p + 1] += offsets[t];
+        }
+        std::copy(chunk_data[t].begin(), chunk_data[t].end(), output.data.begin() + offsets[t]);
+        std::copy(chunk_index[t].begin(), chunk_index[t].end(), output.index.begin() + offsets[t]);
+        std::vector<Value_>().swap(chunk_data[t]);
+        std::vector<Index_>().swap(chunk_index[t]);
+    });
 
     return output;
 }
 
+/**
+ * @brief Stream of simulated primary dimension elements of a compressed sparse matrix.
+ *
+ * @tparam Value_ Type of simulated value. 
+ * @tparam Index_ Integer type for the index.
+ *
+ * This class simulates one primary dimension element at a time, without materializing the entire matrix.
+ * Memory usage is only proportional to the extent of the secondary dimension, allowing us to create very large matrices, e.g., for testing out-of-core backends.
+ * The values for each primary dimension element are identical to those produced by `simulate_compressed_sparse_parallel()` with the same options.
+ */
+template<typename Value_, typename Index_>
+class SimulateCompressedSparseStream {
+public:
+    /**
+     * @param primary Extent of the primary dimension, i.e., the dimension used to compress non-zero elements.
+     * @param secondary Extent of the secondary dimension.
+     * @param options Simulation options.
+     */
+    SimulateCompressedSparseStream(size_t primary, size_t secondary, SimulateCompressedSparseOptions options) : 
+        my_primary(primary), my_secondary(secondary), my_options(std::move(options)) {}
+
+private:
+    size_t my_primary, my_secondary;
+    SimulateCompressedSparseOptions my_options;
+    size_t my_next = 0;
+    std::vector<Value_> my_data;
+    std::vector<Index_> my_index;
+
+public:
+    /**
+     * Simulate the next primary dimension element.
+     * The first call simulates the element at `position()`, which is 0 upon construction.
+     * On success, `value()` and `index()` are filled with the contents of the newly simulated element.
+     *
+     * @return Whether a primary dimension element was simulated.
+     * If false, all elements have already been simulated.
+     */
+    bool next() {
+        if (my_next >= my_primary) {
+            return false;
+        }
+        my_data.clear();
+        my_index.clear();
+        internal::simulate_compressed_sparse_primary(my_next, my_secondary, my_options, my_data, my_index);
+        ++my_next;
+        return true;
+    }
+
+    /**
+     * Move the stream to a different primary dimension element, such that the next call to `next()` will simulate element `p`.
+     * This allows random access to the simulated matrix.
+     *
+     * @param p Index of the primary dimension element, less than or equal to `primary()`.
+     */
+    void seek(size_t p) {
+        my_next = p;
+    }
+
+    /**
+     * @return Index of the primary dimension element to be simulated by the next call to `next()`.
+     */
+    size_t position() const {
+        return my_next;
+    }
+
+    /**
+     * @return Values of the non-zero elements in the most recently simulated primary dimension element.
+     */
+    const std::vector<Value_>& value() const {
+        return my_data;
+    }
+
+    /**
+     * @return Sorted secondary dimension indices of the non-zero elements in the most recently simulated primary dimension element.
+     */
+    const std::vector<Index_>& index() const {
+        return my_index;
+    }
+
+    /**
+     * @return Extent of the primary dimension.
+     */
+    size_t primary() const {
+        return my_primary;
+    }
+
+    /**
+     * @return Extent of the secondary dimension.
+     */
+    size_t secondary() const {
+        return my_secondary;
+    }
+};
+
 }
 
 #endif
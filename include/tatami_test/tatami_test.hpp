@@ -1,14 +1,31 @@
 #ifndef TATAMI_TEST_TATAMI_TEST_HPP
 #define TATAMI_TEST_TATAMI_TEST_HPP
 
+#include "access_sequence.hpp"
+#include "benchmark_access.hpp"
+#include "benchmark_alignment.hpp"
+#include "benchmark_scaling.hpp"
+#include "benchmark_thread_scaling.hpp"
+#include "benchmark_unsorted_access.hpp"
+#include "ChunkedWrapper.hpp"
+#include "count_allocations.hpp"
+#include "count_zero_copy.hpp"
+#include "CountingWrapper.hpp"
 #include "fetch.hpp"
 #include "ForcedOracleWrapper.hpp"
+#include "GuardedBuffer.hpp"
+#include "LatencyWrapper.hpp"
+#include "measure_memory.hpp"
+#include "ProceduralMatrix.hpp"
+#include "report_check_failure.hpp"
 #include "ReversedIndicesWrapper.hpp"
 #include "simulate_vector.hpp"
 #include "simulate_compressed_sparse.hpp"
 #include "test_access.hpp"
+#include "test_concurrent_access.hpp"
 #include "test_unsorted_access.hpp"
 #include "throws_error.hpp"
+#include "TracingOracle.hpp"
 
 /**
  * @file tatami_test.hpp
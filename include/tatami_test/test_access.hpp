@@ -4,19 +4,20 @@
 #include <gtest/gtest.h>
 
 #include "tatami/utils/new_extractor.hpp"
-#include "tatami/utils/ConsecutiveOracle.hpp"
-#include "tatami/utils/FixedOracle.hpp"
+#include "tatami/utils/parallelize.hpp"
 
+#include "access_sequence.hpp"
 #include "fetch.hpp"
-#include "create_indexed_subset.hpp"
+#include "TracingOracle.hpp"
+#include "GuardedBuffer.hpp"
 
 #include <vector>
-#include <limits>
-#include <random>
-#include <cmath>
 #include <memory>
-#include <cstdint>
 #include <type_traits>
+#include <numeric>
+#include <algorithm>
+#include <sstream>
+#include <string>
 
 /**
  * @file test_access.hpp
@@ -25,46 +26,6 @@
 
 namespace tatami_test {
 
-/**
- * Order for accessing rows/columns during `tatami::Matrix` access tests. 
- *
- * - `FORWARD`: rows/columns are accessed in strictly increasing order.
- * - `REVERSE`: rows/columns are accessed in strictly decreasing order.
- * - `RANDOM`: rows/columns are accessed in random order.
- */
-enum class TestAccessOrder : char { FORWARD, REVERSE, RANDOM };
-
-/**
- * @brief Options for `test_full_access()` and friends.
- */
-struct TestAccessOptions {
-    /**
-     * Whether to use an oracle.
-     */
-    bool use_oracle = false;
-
-    /**
-     * Whether to test row access. 
-     * If `false`, column access is tested instead.
-     */
-    bool use_row = true;
-
-    /**
-     * Ordering of row/column accesses in the test.
-     */
-    TestAccessOrder order = TestAccessOrder::FORWARD;
-
-    /**
-     * Minimum distance between rows/columns to be accessed in the test.
-     */
-    int jump = 1;
-
-    /**
-     * Whether to check that "sparse" matrices actually have density below 1.
-     */
-    bool check_sparse = true;
-};
-
 /**
  * Contents of `TestAccessOptions` as a tuple.
  * This is required for GoogleTest's parametrized generators, see `standard_test_access_options_combinations()`.
@@ -100,84 +61,201 @@ inline auto standard_test_access_options_combinations() {
     );
 }
 
+/**
+ * @return A parametrized GoogleTest generator for all `TestAccessOptions` combinations, including all `TestAccessOrder` values.
+ * This is a superset of `standard_test_access_options_combinations()` that also uses the more cache-stressing access orders, 
+ * i.e., `TestAccessOrder::CHUNKED`, `TestAccessOrder::ZIGZAG`, `TestAccessOrder::REPEATED` and `TestAccessOrder::CLUSTERED`.
+ * This should be used inside a `INSTANTIATE_TEST_SUITE_P` macro, which ensures that `GetParam()` in the `TEST_P` body returns a `StandardTestAccessOptions` instance.
+ */
+inline auto extended_test_access_options_combinations() {
+    return ::testing::Combine(
+        ::testing::Values(true, false), /* whether to access the rows. */
+        ::testing::Values(true, false), /* whether to use an oracle. */
+        ::testing::Values(
+            TestAccessOrder::FORWARD,
+            TestAccessOrder::REVERSE,
+            TestAccessOrder::RANDOM,
+            TestAccessOrder::CHUNKED,
+            TestAccessOrder::ZIGZAG,
+            TestAccessOrder::REPEATED,
+            TestAccessOrder::CLUSTERED
+        ), /* access order. */
+        ::testing::Values(1, 3) /* jump between rows/columns. */
+    );
+}
+
 /**
  * @cond
  */
 namespace internal {
 
 template<typename Value_>
-void compare_vectors(const std::vector<Value_>& expected, const std::vector<Value_>& observed, const std::string& context) {
+bool compare_values(Value_ expected, Value_ observed) {
+    if constexpr(std::is_floating_point<Value_>::value) {
+        // Avoiding short-circuiting and std::isnan() so that the compiler can vectorize the loop in compare_vectors().
+        return (expected == observed) | ((expected != expected) & (observed != observed));
+    } else {
+        return expected == observed;
+    }
+}
+
+inline constexpr size_t compare_vectors_max_reported = 5;
+
+template<typename Value_, typename Index_>
+void compare_vectors(const std::vector<Value_>& expected, const std::vector<Value_>& observed, const char* context, Index_ target) {
     size_t n_expected = expected.size();
-    ASSERT_EQ(n_expected, observed.size()) << "mismatch in vector length (" << context << ")";
+    ASSERT_EQ(n_expected, observed.size()) << "mismatch in vector length for row/column " << target << " (" << context << ")";
+
+    // First pass is a branchless count, which should be fast when everything matches.
+    const Value_* eptr = expected.data();
+    const Value_* optr = observed.data();
+    size_t mismatches = 0;
     for (size_t i = 0; i < n_expected; ++i) {
-        auto expected_val = expected[i], observed_val = observed[i];
-        if (std::isnan(expected_val)) {
-            EXPECT_EQ(std::isnan(expected_val), std::isnan(observed_val)) << "mismatching NaNs at position " << i << " (" << context << ")";
-        } else {
-            EXPECT_EQ(expected_val, observed_val) << "different values at position " << i << " (" << context << ")";
+        mismatches += !compare_values(eptr[i], optr[i]);
+    }
+    if (mismatches == 0) {
+        return;
+    }
+
+    // Second pass only occurs upon failure, to report a summary in a single message.
+    std::vector<size_t> positions;
+    double max_diff = 0;
+    for (size_t i = 0; i < n_expected; ++i) {
+        if (compare_values(eptr[i], optr[i])) {
+            continue;
+        }
+        if (positions.size() < compare_vectors_max_reported) {
+            positions.push_back(i);
+        }
+        double diff = std::abs(static_cast<double>(eptr[i]) - static_cast<double>(optr[i]));
+        if (std::isnan(diff)) {
+            max_diff = diff;
+        } else if (!std::isnan(max_diff)) {
+            max_diff = std::max(max_diff, diff);
         }
     }
-}
 
-template<typename Index_>
-uint64_t create_seed(Index_ NR, Index_ NC, const TestAccessOptions& options) {
-    uint64_t seed = static_cast<uint64_t>(NR) * static_cast<uint64_t>(NC);
-    seed += 13 * static_cast<uint64_t>(options.use_row);
-    seed += 57 * static_cast<uint64_t>(options.order);
-    seed += 101 * static_cast<uint64_t>(options.jump);
-    return seed;
+    std::ostringstream msg;
+    msg << mismatches << " mismatching value(s) out of " << n_expected << " for row/column " << target << " (" << context << ")";
+    msg << "\n  first mismatches at position(s):";
+    for (auto p : positions) {
+        msg << " " << p << " (expected " << eptr[p] << ", observed " << optr[p] << ")";
+    }
+    if (mismatches > positions.size()) {
+        msg << " ...";
+    }
+    msg << "\n  maximum absolute difference: " << max_diff;
+    ADD_FAILURE() << msg.str();
 }
 
-template<typename Index_>
-std::vector<Index_> simulate_test_access_sequence(Index_ NR, Index_ NC, const TestAccessOptions& options) {
-    std::vector<Index_> sequence;
-    auto limit = (options.use_row ? NR : NC);
-
-    std::mt19937_64 rng(create_seed(NR, NC, options));
-    Index_ start = rng() % options.jump;
-    if (start < limit) {
-        while (1) {
-            sequence.push_back(start);
-            Index_ remainder = limit - start;
-            // Make sure this comparison involves two unsigned integers to avoid GCC warnings.
-            if (static_cast<typename std::make_unsigned<Index_>::type>(remainder) <= static_cast<typename std::make_unsigned<int>::type>(options.jump)) {
-                break;
+template<typename Value_, typename Index_, typename Target_>
+void compare_sparse_vectors(const SparseVector<Value_, Index_>& expected, const SparseVector<Value_, Index_>& observed, const char* context, Target_ target) {
+    // Walking through both vectors in a single pass, ignoring structural non-zeros that are actually zero.
+    size_t n_expected = expected.index.size(), n_observed = observed.index.size();
+    size_t e = 0, o = 0, mismatches = 0;
+    std::vector<Index_> positions;
+
+    auto add_mismatch = [&](Index_ pos) -> void {
+        ++mismatches;
+        if (positions.size() < compare_vectors_max_reported) {
+            positions.push_back(pos);
+        }
+    };
+
+    while (e < n_expected || o < n_observed) {
+        if (o == n_observed || (e < n_expected && expected.index[e] < observed.index[o])) {
+            if (expected.value[e] != 0) {
+                add_mismatch(expected.index[e]);
             }
-            start += options.jump;
+            ++e;
+        } else if (e == n_expected || observed.index[o] < expected.index[e]) {
+            if (observed.value[o] != 0) {
+                add_mismatch(observed.index[o]);
+            }
+            ++o;
+        } else {
+            if (!compare_values(expected.value[e], observed.value[o])) {
+                add_mismatch(expected.index[e]);
+            }
+            ++e;
+            ++o;
         }
     }
 
-    if (options.order == TestAccessOrder::REVERSE) {
-        std::reverse(sequence.begin(), sequence.end());
-    } else if (options.order == TestAccessOrder::RANDOM) {
-        std::shuffle(sequence.begin(), sequence.end(), rng);
+    if (mismatches == 0) {
+        return;
     }
 
-    return sequence;
+    std::ostringstream msg;
+    msg << mismatches << " mismatching non-zero(s) for row/column " << target << " (" << context << ")";
+    msg << "\n  first mismatches at index(es):";
+    for (auto p : positions) {
+        msg << " " << p;
+    }
+    if (mismatches > positions.size()) {
+        msg << " ...";
+    }
+    ADD_FAILURE() << msg.str();
 }
 
+template<typename Value_>
+class SparseExpansion {
+public:
+    SparseExpansion(size_t extent) : my_values(extent) {
+        my_written.reserve(extent);
+    }
+
+    // Only zeroing the positions that were written by the previous call, 
+    // so that the cost of each call is proportional to the number of non-zeros.
+    template<typename Index_, class Position_>
+    const std::vector<Value_>& set(const SparseVector<Value_, Index_>& svec, Position_ position) {
+        for (auto p : my_written) {
+            my_values[p] = 0;
+        }
+        my_written.clear();
+
+        size_t nnz = svec.index.size();
+        for (size_t i = 0; i < nnz; ++i) {
+            size_t p = position(svec.index[i]);
+            my_values[p] = svec.value[i];
+            my_written.push_back(p);
+        }
+        return my_values;
+    }
+
+    const std::vector<Value_>& values() const {
+        return my_values;
+    }
+
+private:
+    std::vector<Value_> my_values;
+    std::vector<size_t> my_written;
+};
+
+// Only used in the tests, as the recording in TracingOracle::get() adds overhead that would distort the benchmarks.
 template<bool use_oracle_, typename Index_>
-tatami::MaybeOracle<use_oracle_, Index_> create_oracle(const std::vector<Index_>& sequence, const TestAccessOptions& options) {
+typename std::conditional<use_oracle_, std::shared_ptr<TracingOracle<Index_> >, bool>::type create_tracing_oracle(const Index_* sequence, size_t length, const TestAccessOptions& options) {
     if constexpr(use_oracle_) {
-        std::shared_ptr<tatami::Oracle<Index_> > oracle;
-        if (options.jump == 1 && options.order == TestAccessOrder::FORWARD) {
-            oracle.reset(new tatami::ConsecutiveOracle<Index_>(0, sequence.size()));
-        } else {
-            oracle.reset(new tatami::FixedViewOracle<Index_>(sequence.data(), sequence.size()));
-        }
-        return oracle;
+        return std::make_shared<TracingOracle<Index_> >(create_oracle<true>(sequence, length, options));
     } else {
         return false;
     }
 }
 
-template<bool use_oracle_, typename Value_, typename Index_, class SparseExpand_, typename ...Args_>
+template<class Function_>
+void parallelize_test_access(size_t length, const TestAccessOptions& options, Function_ fun) {
+    tatami::parallelize([&](size_t t, size_t start, size_t len) -> void {
+        fun(t, start, len);
+    }, length, std::max(options.num_threads, 1));
+}
+
+template<bool use_oracle_, typename Value_, typename Index_, class Position_, typename ...Args_>
 void test_access_base(
     const tatami::Matrix<Value_, Index_>& matrix, 
     const tatami::Matrix<Value_, Index_>& reference, 
     const TestAccessOptions& options, 
     Index_ extent,
-    SparseExpand_ sparse_expand, 
+    Position_ position, 
     Args_... args) 
 {
     auto NR = matrix.nrow();
@@ -185,106 +263,178 @@ void test_access_base(
     auto NC = matrix.ncol();
     ASSERT_EQ(NC, reference.ncol());
 
-    auto refwork = (options.use_row ? reference.dense_row(args...) : reference.dense_column(args...));
-
     auto sequence = simulate_test_access_sequence(NR, NC, options);
-    auto oracle = create_oracle<use_oracle_>(sequence, options);
-
-    auto pwork = tatami::new_extractor<false, use_oracle_>(&matrix, options.use_row, oracle, args...);
-    auto swork = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args...);
-
-    tatami::Options opt;
-    opt.sparse_extract_index = false;
-    auto swork_v = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+    std::vector<size_t> sparse_counters(std::max(options.num_threads, 1));
+    std::vector<size_t> peak_depths(sparse_counters.size()), out_of_range(sparse_counters.size());
+
+    parallelize_test_access(sequence.size(), options, [&](size_t t, size_t start, size_t length) -> void {
+        std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > refwork;
+        std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > refswork;
+        if (options.sparse_reference) {
+            refswork = (options.use_row ? reference.sparse_row(args...) : reference.sparse_column(args...));
+        } else {
+            refwork = (options.use_row ? reference.dense_row(args...) : reference.dense_column(args...));
+        }
 
-    opt.sparse_extract_value = false;
-    auto swork_n = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+        auto tracer = create_tracing_oracle<use_oracle_>(sequence.data() + start, length, options);
+        tatami::MaybeOracle<use_oracle_, Index_> oracle = tracer;
+
+        auto pwork = tatami::new_extractor<false, use_oracle_>(&matrix, options.use_row, oracle, args...);
+        auto swork = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args...);
+
+        tatami::Options opt;
+        opt.sparse_extract_index = false;
+        auto swork_v = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        opt.sparse_extract_value = false;
+        auto swork_n = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        opt.sparse_extract_index = true;
+        auto swork_i = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        size_t& sparse_counter = sparse_counters[t];
+
+        // Allocating the output buffers for the tested extractors once, optionally with guard pages.
+        // Results are always copied into the (unguarded) vectors for comparison, so the latter never need to be resized to the full extent.
+        std::unique_ptr<GuardedBuffer<Value_> > vguard;
+        std::unique_ptr<GuardedBuffer<Index_> > iguard;
+        std::vector<Value_> vscratch;
+        std::vector<Index_> iscratch;
+        Value_* vbuffer;
+        Index_* ibuffer;
+        if (options.guard_buffers) {
+            vguard.reset(new GuardedBuffer<Value_>(extent));
+            iguard.reset(new GuardedBuffer<Index_>(extent));
+            vbuffer = vguard->data();
+            ibuffer = iguard->data();
+        } else {
+            vscratch.resize(extent);
+            iscratch.resize(extent);
+            vbuffer = vscratch.data();
+            ibuffer = iscratch.data();
+        }
 
-    opt.sparse_extract_index = true;
-    auto swork_i = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+        // Reusing the same buffers across iterations to avoid repeated allocations.
+        std::vector<Value_> expected_dense, observed_dense, values;
+        std::vector<Index_> indices;
+        SparseVector<Value_, Index_> observed, expected_sparse;
+        SparseExpansion<Value_> expected_expansion(options.sparse_reference ? extent : 0), observed_expansion(extent);
+        const auto& expected = (options.sparse_reference ? expected_expansion.values() : expected_dense);
+
+        // Looping over rows/columns and checking extraction against the reference.
+        for (size_t s = start, end = start + length; s < end; ++s) {
+            auto i = sequence[s];
+            if constexpr(use_oracle_) {
+                tracer->set_position(s - start);
+            }
 
-    size_t sparse_counter = 0;
+            if (options.sparse_reference) {
+                fetch(*refswork, i, extent, expected_sparse);
+                expected_expansion.set(expected_sparse, position);
+            } else {
+                fetch(*refwork, i, extent, expected_dense);
+            }
 
-    // Looping over rows/columns and checking extraction against the reference.
-    for (auto i : sequence) {
-        auto expected = fetch(*refwork, i, extent);
+            // Checking dense retrieval first.
+            {
+                auto raw = [&]() {
+                    if constexpr(use_oracle_) {
+                        return pwork->fetch(vbuffer);
+                    } else {
+                        return pwork->fetch(i, vbuffer);
+                    }
+                }();
+                observed_dense.assign(raw, raw + extent);
+                compare_vectors(expected, observed_dense, "dense retrieval", i);
+            }
 
-        // Checking dense retrieval first.
-        {
-            auto observed = [&]() {
-                if constexpr(use_oracle_) {
-                    return fetch(*pwork, extent);
+            // Various flavors of sparse retrieval.
+            {
+                auto raw = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork->fetch(vbuffer, ibuffer);
+                    } else {
+                        return swork->fetch(i, vbuffer, ibuffer);
+                    }
+                }();
+                observed.value.assign(raw.value, raw.value + raw.number);
+                observed.index.assign(raw.index, raw.index + raw.number);
+                if (options.sparse_reference) {
+                    compare_sparse_vectors(expected_sparse, observed, "sparse retrieval", i);
                 } else {
-                    return fetch(*pwork, i, extent);
+                    compare_vectors(expected, observed_expansion.set(observed, position), "sparse retrieval", i);
                 }
-            }();
-            compare_vectors(expected, observed, "dense retrieval");
-        }
 
-        // Various flavors of sparse retrieval.
-        {
-            auto observed = [&]() {
-                if constexpr(use_oracle_) {
-                    return fetch(*swork, extent);
-                } else {
-                    return fetch(*swork, i, extent);
+                sparse_counter += observed.value.size();
+                {
+                    bool is_increasing = true;
+                    for (size_t i = 1; i < observed.index.size(); ++i) {
+                        if (observed.index[i] <= observed.index[i-1]) {
+                            is_increasing = false;
+                            break;
+                        }
+                    }
+                    ASSERT_TRUE(is_increasing);
                 }
-            }();
-            compare_vectors(expected, sparse_expand(observed), "sparse retrieval");
 
-            sparse_counter += observed.value.size();
-            {
-                bool is_increasing = true;
-                for (size_t i = 1; i < observed.index.size(); ++i) {
-                    if (observed.index[i] <= observed.index[i-1]) {
-                        is_increasing = false;
-                        break;
+                auto observed_i = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_i->fetch(NULL, ibuffer);
+                    } else {
+                        return swork_i->fetch(i, NULL, ibuffer);
                     }
-                }
-                ASSERT_TRUE(is_increasing);
-            }
+                }();
+                ASSERT_TRUE(observed_i.value == NULL);
+                indices.assign(observed_i.index, observed_i.index + observed_i.number);
+                ASSERT_EQ(observed.index, indices);
+
+                auto observed_v = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_v->fetch(vbuffer, NULL);
+                    } else {
+                        return swork_v->fetch(i, vbuffer, NULL);
+                    }
+                }();
+                ASSERT_TRUE(observed_v.index == NULL);
+                values.assign(observed_v.value, observed_v.value + observed_v.number);
+                compare_vectors(values, observed.value, "sparse retrieval with values only", i);
+
+                auto observed_n = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_n->fetch(NULL, NULL);
+                    } else {
+                        return swork_n->fetch(i, NULL, NULL);
+                    }
+                }();
+                ASSERT_TRUE(observed_n.value == NULL);
+                ASSERT_TRUE(observed_n.index == NULL);
+                ASSERT_EQ(observed.value.size(), observed_n.number);
+            } 
+        }
 
-            std::vector<Index_> indices(extent);
-            auto observed_i = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_i->fetch(NULL, indices.data());
-                } else {
-                    return swork_i->fetch(i, NULL, indices.data());
-                }
-            }();
-            ASSERT_TRUE(observed_i.value == NULL);
-            tatami::copy_n(observed_i.index, observed_i.number, indices.data());
-            indices.resize(observed_i.number);
-            ASSERT_EQ(observed.index, indices);
-
-            std::vector<Value_> values(extent);
-            auto observed_v = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_v->fetch(values.data(), NULL);
-                } else {
-                    return swork_v->fetch(i, values.data(), NULL);
-                }
-            }();
-            ASSERT_TRUE(observed_v.index == NULL);
-            tatami::copy_n(observed_v.value, observed_v.number, values.data());
-            values.resize(observed_v.number);
-            compare_vectors(values, observed.value, "sparse retrieval with values only");
-
-            auto observed_n = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_n->fetch(NULL, NULL);
-                } else {
-                    return swork_n->fetch(i, NULL, NULL);
-                }
-            }();
-            ASSERT_TRUE(observed_n.value == NULL);
-            ASSERT_TRUE(observed_n.index == NULL);
-            ASSERT_EQ(observed.value.size(), observed_n.number);
-        } 
+        if (options.guard_buffers) {
+            EXPECT_TRUE(vguard->intact() && iguard->intact()) << "writes detected before the start of the output buffers";
+        }
+
+        if constexpr(use_oracle_) {
+            peak_depths[t] = tracer->peak_depth();
+            out_of_range[t] = tracer->out_of_range();
+        }
+    });
+
+    if constexpr(use_oracle_) {
+        size_t peak_depth = *std::max_element(peak_depths.begin(), peak_depths.end());
+        ::testing::Test::RecordProperty("peak_prefetch_depth", std::to_string(peak_depth));
+        EXPECT_LE(peak_depth, options.max_prefetch_depth) << "oracular extraction prefetches too far ahead";
+        EXPECT_EQ(std::accumulate(out_of_range.begin(), out_of_range.end(), static_cast<size_t>(0)), 0) << "predictions requested beyond the end of the oracle";
     }
 
+    size_t sparse_counter = std::accumulate(sparse_counters.begin(), sparse_counters.end(), static_cast<size_t>(0));
+
     if (options.check_sparse && matrix.is_sparse()) {
-        EXPECT_TRUE(sparse_counter < static_cast<size_t>(NR) * static_cast<size_t>(NC));
+        // Scaling by the length of the sequence, as some access orders will visit the same row/column multiple times.
+        size_t nsecondary = (options.use_row ? NC : NR);
+        EXPECT_TRUE(sparse_counter < sequence.size() * nsecondary);
     }
 }
 
@@ -300,13 +450,8 @@ void test_full_access(
         reference,
         options,
         nsecondary,
-        [&](const auto& svec) -> auto {
-            std::vector<Value_> output(nsecondary);
-            size_t nnz = svec.index.size();
-            for (size_t i = 0; i < nnz; ++i) {
-                output[svec.index[i]] = svec.value[i];
-            }
-            return output;
+        [&](Index_ i) -> size_t {
+            return i;
         }
     );
 }
@@ -327,13 +472,8 @@ void test_block_access(
         reference, 
         options,
         length,
-        [&](const auto& svec) -> auto {
-            std::vector<Value_> output(length);
-            size_t nnz = svec.index.size();
-            for (size_t i = 0; i < nnz; ++i) {
-                output[svec.index[i] - start] = svec.value[i];
-            }
-            return output;
+        [&](Index_ i) -> size_t {
+            return i - start;
         },
         start,
         length
@@ -349,12 +489,7 @@ void test_indexed_access(
     const TestAccessOptions& options)
 {
     Index_ nsecondary = (options.use_row ? reference.ncol() : reference.nrow());
-    auto index_ptr = create_indexed_subset(
-        nsecondary,
-        relative_start,
-        probability,
-        create_seed(matrix.nrow(), matrix.ncol(), options) + 999 * probability + 85 * relative_start
-    );
+    auto index_ptr = create_test_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
 
     Index_ num_indices = index_ptr->size();
     std::vector<size_t> reposition(nsecondary, -1);
@@ -370,13 +505,8 @@ void test_indexed_access(
         reference,
         options,
         num_indices,
-        [&](const auto& svec) -> auto {
-            std::vector<Value_> expected(num_indices);
-            size_t nnz = svec.index.size();
-            for (size_t i = 0; i < nnz; ++i) {
-                expected[reposition[svec.index[i]]] = svec.value[i];
-            }
-            return expected;
+        [&](Index_ i) -> size_t {
+            return reposition[i];
         },
         std::move(index_ptr)
     );
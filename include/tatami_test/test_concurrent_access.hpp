@@ -0,0 +1,179 @@
+#ifndef TATAMI_TEST_TEST_CONCURRENT_ACCESS_HPP
+#define TATAMI_TEST_TEST_CONCURRENT_ACCESS_HPP
+
+#include <gtest/gtest.h>
+
+#include "tatami/base/Matrix.hpp"
+
+#include "test_access.hpp"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file test_concurrent_access.hpp
+ * @brief Test concurrent access from multiple extractors on the same `tatami::Matrix`.
+ */
+
+namespace tatami_test {
+
+/**
+ * @brief Options for `test_concurrent_access()`.
+ */
+struct TestConcurrentAccessOptions {
+    /**
+     * Numbers of threads to test.
+     * A separate round of testing is performed for each entry.
+     */
+    std::vector<int> num_threads { 1, 2, 4, 8 };
+
+    /**
+     * Seed for the PRNG used to choose the access pattern for each thread.
+     */
+    uint64_t seed = 9876543210;
+};
+
+/**
+ * @brief Results of a single round of `test_concurrent_access()`.
+ */
+struct TestConcurrentAccessResult {
+    /**
+     * Number of threads used in this round.
+     */
+    int num_threads = 0;
+
+    /**
+     * Total number of rows/columns that were extracted and checked across all threads.
+     */
+    size_t checked = 0;
+
+    /**
+     * Wall-clock time for this round, in seconds.
+     */
+    double seconds = 0;
+
+    /**
+     * @return Aggregate throughput, in checked rows/columns per second.
+     */
+    double checked_per_second() const {
+        return (seconds > 0 ? checked / seconds : 0);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<typename Value_, typename Index_>
+size_t test_concurrent_access_thread(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    int thread,
+    uint64_t seed)
+{
+    // Each thread gets a different combination of options and selections, to maximize the variety of extractors used at the same time.
+    TestAccessOptions options;
+    options.use_row = (thread % 2 == 0);
+    options.use_oracle = ((thread / 2) % 2 == 1);
+    options.order = static_cast<TestAccessOrder>(thread % 7);
+    options.jump = 1 + thread % 3;
+
+    std::mt19937_64 rng(seed + 1000003 * static_cast<uint64_t>(thread));
+    std::uniform_real_distribution<> unif(0.0, 1.0);
+    double relative_start = unif(rng) * 0.5;
+    double relative_length = 0.1 + unif(rng) * 0.4;
+    double probability = 0.1 + unif(rng) * 0.8;
+
+    switch ((thread / 4) % 3) {
+        case 0:
+            test_full_access(matrix, reference, options);
+            break;
+        case 1:
+            test_block_access(matrix, reference, relative_start, relative_length, options);
+            break;
+        default:
+            test_indexed_access(matrix, reference, relative_start, probability, options);
+    }
+
+    return simulate_test_access_sequence(matrix.nrow(), matrix.ncol(), options).size();
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Test concurrent access to `matrix` from multiple threads.
+ * In each round, the specified number of threads are started at the same time, and each thread runs `test_full_access()`, `test_block_access()` or `test_indexed_access()` with its own extractors.
+ * Each thread uses a different combination of `TestAccessOptions` and selections, e.g., row or column access, with or without an oracle, and different access orders.
+ * Any discrepancies between `matrix` and `reference` will raise a GoogleTest error.
+ *
+ * This is intended to detect thread-unsafe behavior in `matrix`, e.g., lazily initialized caches or other mutable state that is shared between extractors.
+ * It is most effective when compiled with a thread sanitizer, e.g., `-fsanitize=thread`.
+ *
+ * @tparam Value_ Type of the data.
+ * @tparam Index_ Integer type for the row/column index.
+ *
+ * @param matrix Matrix for which to test access.
+ * @param reference Reference matrix containing the same values as `matrix`.
+ * This typically uses a "known-good" representation like a `tatami::DenseRowMatrix`.
+ * @param options Further options for testing.
+ *
+ * @return Aggregate throughput for each round, in the same order as `TestConcurrentAccessOptions::num_threads`.
+ */
+template<typename Value_, typename Index_>
+std::vector<TestConcurrentAccessResult> test_concurrent_access(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const tatami::Matrix<Value_, Index_>& reference,
+    const TestConcurrentAccessOptions& options)
+{
+    std::vector<TestConcurrentAccessResult> output;
+    output.reserve(options.num_threads.size());
+
+    for (auto nthreads : options.num_threads) {
+        nthreads = std::max(nthreads, 1);
+        std::vector<size_t> checked(nthreads);
+        std::vector<std::thread> workers;
+        workers.reserve(nthreads);
+
+        // All threads wait for each other before starting, to maximize the overlap between extractors.
+        std::atomic<int> ready{0};
+        auto start = std::chrono::steady_clock::now();
+
+        for (int t = 0; t < nthreads; ++t) {
+            workers.emplace_back([&](int thread) -> void {
+                ++ready;
+                while (ready.load() < nthreads) {
+                    std::this_thread::yield();
+                }
+                checked[thread] = internal::test_concurrent_access_thread(matrix, reference, thread, options.seed);
+            }, t);
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        TestConcurrentAccessResult res;
+        res.num_threads = nthreads;
+        for (auto c : checked) {
+            res.checked += c;
+        }
+        res.seconds = std::chrono::duration<double>(end - start).count();
+        output.push_back(res);
+    }
+
+    return output;
+}
+
+}
+
+#endif
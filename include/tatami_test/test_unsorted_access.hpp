@@ -34,107 +34,133 @@ void test_unsorted_access_base(const tatami::Matrix<Value_, Index_>& matrix, con
     auto NC = matrix.ncol();
 
     auto sequence = simulate_test_access_sequence(NR, NC, options);
-    auto oracle = create_oracle<use_oracle_>(sequence, options);
-    auto swork = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args...);
-
-    tatami::Options opt;
-    opt.sparse_ordered_index = false;
-    auto swork_uns = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
-
-    opt.sparse_extract_index = false;
-    auto swork_uns_v = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
-
-    opt.sparse_extract_value = false;
-    auto swork_uns_n = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
-
-    opt.sparse_extract_index = true;
-    auto swork_uns_i = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
-
-    // Looping over rows/columns and checking extraction for various unsorted combinations.
-    for (auto i : sequence) {
-        auto observed = [&]() {
+    parallelize_test_access(sequence.size(), options, [&](size_t, size_t start, size_t length) -> void {
+        auto oracle = create_oracle<use_oracle_>(sequence.data() + start, length, options);
+        auto swork = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args...);
+
+        tatami::Options opt;
+        opt.sparse_ordered_index = false;
+        auto swork_uns = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        opt.sparse_extract_index = false;
+        auto swork_uns_v = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        opt.sparse_extract_value = false;
+        auto swork_uns_n = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        opt.sparse_extract_index = true;
+        auto swork_uns_i = tatami::new_extractor<true, use_oracle_>(&matrix, options.use_row, oracle, args..., opt);
+
+        // Reusing the same buffers across iterations to avoid repeated allocations.
+        SparseVector<Value_, Index_> observed, observed_uns;
+        std::vector<Value_> values;
+        std::vector<Index_> indices;
+
+        // Mapping each index in the non-target dimension to its (1-based) position in the sorted output, or 0 if it is absent.
+        // This allows us to check that the unsorted output is a permutation of the sorted output in linear time.
+        std::vector<size_t> slots(options.use_row ? NC : NR);
+        auto in_range = [&](Index_ x) -> bool {
+            return static_cast<size_t>(x) < slots.size(); // negative indices wrap around to large values.
+        };
+
+        // Looping over rows/columns and checking extraction for various unsorted combinations.
+        for (size_t s = start, end = start + length; s < end; ++s) {
+            auto i = sequence[s];
             if constexpr(use_oracle_) {
-                return fetch(*swork, extent);
+                fetch(*swork, extent, observed);
+                fetch(*swork_uns, extent, observed_uns);
             } else {
-                return fetch(*swork, i, extent);
+                fetch(*swork, i, extent, observed);
+                fetch(*swork_uns, i, extent, observed_uns);
             }
-        }();
 
-        auto observed_uns = [&]() {
-            if constexpr(use_oracle_) {
-                return fetch(*swork_uns, extent);
-            } else {
-                return fetch(*swork_uns, i, extent);
-            }
-        }();
-
-        {
-            // Poor man's zip + unzip.
-            std::vector<std::pair<Index_, Value_> > collected;
-            collected.reserve(observed.value.size());
-            for (Index_ i = 0, end = observed_uns.value.size(); i < end; ++i) {
-                collected.emplace_back(observed_uns.index[i], observed_uns.value[i]);
-            }
-            std::sort(collected.begin(), collected.end());
-
-            std::vector<Value_> sorted_v;
-            std::vector<Index_> sorted_i;
-            sorted_v.reserve(collected.size());
-            sorted_i.reserve(collected.size());
-            for (const auto& p : collected) {
-                sorted_i.push_back(p.first);
-                sorted_v.push_back(p.second);
-            }
+            {
+                size_t nnz = observed.index.size();
+                ASSERT_EQ(nnz, observed_uns.index.size()) << "different number of non-zeros for row/column " << i << " (unsorted sparse)";
+                size_t bad_order = 0, bad_index = 0, bad_value = 0;
+                for (size_t k = 0; k < nnz; ++k) {
+                    auto x = observed.index[k];
+                    bad_order += (k > 0 && x <= observed.index[k - 1]);
+                    if (in_range(x)) {
+                        slots[x] = k + 1;
+                    } else {
+                        ++bad_index;
+                    }
+                }
 
-            ASSERT_EQ(observed.index, sorted_i);
-            compare_vectors(observed.value, sorted_v, "unsorted sparse");
-        }
+                for (size_t k = 0; k < nnz; ++k) {
+                    auto x = observed_uns.index[k];
+                    if (!in_range(x)) {
+                        ++bad_index;
+                        continue;
+                    }
+                    auto& current = slots[x];
+                    if (current == 0) { // either absent from the sorted output or a duplicate.
+                        ++bad_index;
+                    } else {
+                        bad_value += !compare_values(observed.value[current - 1], observed_uns.value[k]);
+                        current = 0;
+                    }
+                }
 
-        {
-            std::vector<int> indices(extent);
-            auto observed_i = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_uns_i->fetch(NULL, indices.data());
-                } else {
-                    return swork_uns_i->fetch(i, NULL, indices.data());
+                // Resetting the slots for the next iteration, in case some were not consumed.
+                for (auto x : observed.index) {
+                    if (in_range(x)) {
+                        slots[x] = 0;
+                    }
                 }
-            }();
-            ASSERT_TRUE(observed_i.value == NULL);
 
-            tatami::copy_n(observed_i.index, observed_i.number, indices.data());
-            indices.resize(observed_i.number);
-            ASSERT_EQ(observed_uns.index, indices);
-        }
+                ASSERT_EQ(bad_order, 0) << "indices are not strictly increasing for row/column " << i << " (sorted sparse)";
+                ASSERT_EQ(bad_index, 0) << "unsorted indices are out of range or not a permutation of the sorted indices for row/column " << i;
+                EXPECT_EQ(bad_value, 0) << "different values after reordering for row/column " << i << " (unsorted sparse)";
+            }
 
-        {
-            std::vector<double> values(extent);
-            auto observed_v = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_uns_v->fetch(values.data(), NULL);
-                } else {
-                    return swork_uns_v->fetch(i, values.data(), NULL);
-                }
-            }();
-            ASSERT_TRUE(observed_v.index == NULL);
+            {
+                indices.resize(extent);
+                auto observed_i = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_uns_i->fetch(NULL, indices.data());
+                    } else {
+                        return swork_uns_i->fetch(i, NULL, indices.data());
+                    }
+                }();
+                ASSERT_TRUE(observed_i.value == NULL);
+
+                tatami::copy_n(observed_i.index, observed_i.number, indices.data());
+                indices.resize(observed_i.number);
+                ASSERT_EQ(observed_uns.index, indices);
+            }
 
-            tatami::copy_n(observed_v.value, observed_v.number, values.data());
-            values.resize(observed_v.number);
-            compare_vectors(observed_uns.value, values, "unsorted sparse, values only");
-        }
+            {
+                values.resize(extent);
+                auto observed_v = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_uns_v->fetch(values.data(), NULL);
+                    } else {
+                        return swork_uns_v->fetch(i, values.data(), NULL);
+                    }
+                }();
+                ASSERT_TRUE(observed_v.index == NULL);
+
+                tatami::copy_n(observed_v.value, observed_v.number, values.data());
+                values.resize(observed_v.number);
+                compare_vectors(observed_uns.value, values, "unsorted sparse, values only", i);
+            }
 
-        {
-            auto observed_n = [&]() {
-                if constexpr(use_oracle_) {
-                    return swork_uns_n->fetch(NULL, NULL);
-                } else {
-                    return swork_uns_n->fetch(i, NULL, NULL);
-                }
-            }();
-            ASSERT_TRUE(observed_n.value == NULL);
-            ASSERT_TRUE(observed_n.index == NULL);
-            ASSERT_EQ(observed.value.size(), observed_n.number);
+            {
+                auto observed_n = [&]() {
+                    if constexpr(use_oracle_) {
+                        return swork_uns_n->fetch(NULL, NULL);
+                    } else {
+                        return swork_uns_n->fetch(i, NULL, NULL);
+                    }
+                }();
+                ASSERT_TRUE(observed_n.value == NULL);
+                ASSERT_TRUE(observed_n.index == NULL);
+                ASSERT_EQ(observed.value.size(), observed_n.number);
+            }
         }
-    }
+    });
 }
 
 template<bool use_oracle_, typename Value_, typename Index_>
@@ -153,13 +179,7 @@ void test_unsorted_block_access(const tatami::Matrix<Value_, Index_>& matrix, do
 
 template<bool use_oracle_, typename Value_, typename Index_>
 void test_unsorted_indexed_access(const tatami::Matrix<Value_, Index_>& matrix, double relative_start, double probability, const TestAccessOptions& options) {
-    Index_ nsecondary = (options.use_row ? matrix.ncol() : matrix.nrow());
-    auto index_ptr = create_indexed_subset(
-        nsecondary,
-        relative_start,
-        probability,
-        create_seed(matrix.nrow(), matrix.ncol(), options) + 1001 * probability + 13 * relative_start
-    );
+    auto index_ptr = create_test_unsorted_indexed_subset(matrix.nrow(), matrix.ncol(), relative_start, probability, options);
     Index_ num_indices = index_ptr->size();
     internal::test_unsorted_access_base<use_oracle_>(matrix, options, num_indices, std::move(index_ptr));
 }
@@ -0,0 +1,173 @@
+#include "tatami_test/ChunkedWrapper.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include <numeric>
+#include <random>
+
+static tatami_test::ChunkedWrapperOptions default_options(size_t cache_size) {
+    tatami_test::ChunkedWrapperOptions copt;
+    copt.chunk_nrow = 10;
+    copt.chunk_ncol = 10;
+    copt.cache_size = cache_size;
+    return copt;
+}
+
+class ChunkedWrapperTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(ChunkedWrapperTest, Parametrized) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    tatami_test::ChunkedWrapper<double, int> wrapped(mat, default_options(20));
+    EXPECT_TRUE(wrapped.uses_oracle(true));
+
+    tatami_test::test_full_access(wrapped, *mat, options);
+    tatami_test::test_block_access(wrapped, *mat, 0.17, 0.3, options);
+    tatami_test::test_indexed_access(wrapped, *mat, 0.05, 0.2, options);
+
+    auto stats = wrapped.statistics(options.use_oracle);
+    EXPECT_GT(stats.loads, 0);
+    EXPECT_EQ(wrapped.statistics(!options.use_oracle).loads, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ChunkedWrapper,
+    ChunkedWrapperTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(ChunkedWrapper, Forward) {
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    tatami_test::ChunkedWrapper<double, int> wrapped(mat, default_options(10));
+    std::vector<double> buffer(NC);
+
+    // Each row chunk is loaded exactly once, with 5 chunks across the columns.
+    auto ext = wrapped.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        ext->fetch(r, buffer.data());
+    }
+    auto stats = wrapped.statistics(false);
+    EXPECT_EQ(stats.loads, 50);
+    EXPECT_EQ(stats.hits, 450);
+
+    // Block extraction only loads the chunks overlapping the block.
+    wrapped.reset();
+    auto bext = wrapped.dense_row(15, 10);
+    for (int r = 0; r < NR; ++r) {
+        bext->fetch(r, buffer.data());
+    }
+    EXPECT_EQ(wrapped.statistics(false).loads, 20);
+
+    // Same for indexed extraction.
+    wrapped.reset();
+    auto iext = wrapped.dense_row(std::make_shared<const std::vector<int> >(std::vector<int>{ 1, 2, 45 }));
+    for (int r = 0; r < NR; ++r) {
+        iext->fetch(r, buffer.data());
+    }
+    EXPECT_EQ(wrapped.statistics(false).loads, 20);
+
+    // Column extraction loads one slab of 10 chunks per 10 columns.
+    wrapped.reset();
+    std::vector<double> cbuffer(NR);
+    auto cext = wrapped.dense_column();
+    for (int c = 0; c < NC; ++c) {
+        cext->fetch(c, cbuffer.data());
+    }
+    EXPECT_EQ(wrapped.statistics(false).loads, 50);
+}
+
+TEST(ChunkedWrapper, UsesOracle) {
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    tatami_test::ChunkedWrapper<double, int> cached(mat, default_options(10));
+    EXPECT_TRUE(cached.uses_oracle(true));
+    EXPECT_TRUE(cached.uses_oracle(false));
+
+    // Without a cache, this is forwarded from the wrapped matrix.
+    tatami_test::ChunkedWrapper<double, int> uncached(mat, default_options(0));
+    EXPECT_EQ(uncached.uses_oracle(true), mat->uses_oracle(true));
+    EXPECT_EQ(uncached.uses_oracle(false), mat->uses_oracle(false));
+    tatami_test::test_full_access(uncached, *mat, tatami_test::TestAccessOptions());
+}
+
+TEST(ChunkedWrapper, OracleVersusMyopic) {
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    std::vector<int> sequence(NR);
+    std::iota(sequence.begin(), sequence.end(), 0);
+    std::mt19937_64 rng(42);
+    std::shuffle(sequence.begin(), sequence.end(), rng);
+
+    // Cache can hold 4 slabs of 5 chunks each.
+    tatami_test::ChunkedWrapper<double, int> wrapped(mat, default_options(20));
+    std::vector<double> buffer(NC);
+
+    auto ext = wrapped.dense_row();
+    for (auto r : sequence) {
+        ext->fetch(r, buffer.data());
+    }
+    auto myopic = wrapped.statistics(false);
+
+    auto oext = wrapped.dense_row(std::make_shared<tatami::FixedViewOracle<int> >(sequence.data(), sequence.size()));
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        oext->fetch(buffer.data());
+    }
+    auto oracular = wrapped.statistics(true);
+
+    EXPECT_EQ(myopic.loads + myopic.hits, 500);
+    EXPECT_GT(oracular.hits, 0); // loads include prefetched slabs, so they don't sum with the hits to the number of fetches.
+    EXPECT_LT(oracular.loads, myopic.loads);
+    EXPECT_GE(oracular.loads, 50);
+
+    // With a large enough cache, each chunk is only loaded once.
+    tatami_test::ChunkedWrapper<double, int> big(mat, default_options(1000));
+    auto bext = big.dense_row();
+    for (auto r : sequence) {
+        bext->fetch(r, buffer.data());
+    }
+    EXPECT_EQ(big.statistics(false).loads, 50);
+
+    // With no cache, each fetch requires a load.
+    tatami_test::ChunkedWrapper<double, int> none(mat, default_options(0));
+    auto next = none.dense_row(std::make_shared<tatami::FixedViewOracle<int> >(sequence.data(), sequence.size()));
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        next->fetch(buffer.data());
+    }
+    EXPECT_EQ(none.statistics(true).loads, 500);
+}
+
+TEST(ChunkedWrapper, SmallerThanSlab) {
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+
+    // Cache is smaller than a slab of 5 chunks, but still holds one slab.
+    tatami_test::ChunkedWrapper<double, int> wrapped(mat, default_options(3));
+    EXPECT_TRUE(wrapped.uses_oracle(true));
+    std::vector<double> buffer(NC);
+
+    auto ext = wrapped.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        ext->fetch(r, buffer.data());
+    }
+    auto myopic = wrapped.statistics(false);
+    EXPECT_EQ(myopic.loads, 50);
+    EXPECT_EQ(myopic.hits, 450);
+
+    auto oext = wrapped.dense_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR));
+    for (int r = 0; r < NR; ++r) {
+        oext->fetch(buffer.data());
+    }
+    auto oracular = wrapped.statistics(true);
+    EXPECT_EQ(oracular.loads, 50);
+    EXPECT_EQ(oracular.hits, 450);
+
+    tatami_test::test_full_access(wrapped, *mat, tatami_test::TestAccessOptions());
+}
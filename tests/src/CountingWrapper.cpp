@@ -0,0 +1,88 @@
+#include "tatami_test/CountingWrapper.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami/tatami.hpp"
+
+#include "utils.h"
+
+class CountingWrapperTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(CountingWrapperTest, Parametrized) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 91, NC = 73;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    tatami_test::CountingWrapper<double, int> wrapped(mat);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+    size_t extent = (options.use_row ? NC : NR);
+
+    tatami_test::test_full_access(wrapped, *mat, options);
+    {
+        auto dstats = wrapped.statistics(false, options.use_oracle, tatami_test::CountingSelection::FULL);
+        EXPECT_EQ(dstats.extractors, 1);
+        EXPECT_EQ(dstats.fetches, sequence.size());
+        EXPECT_EQ(dstats.elements, sequence.size() * extent);
+
+        auto sstats = wrapped.statistics(true, options.use_oracle, tatami_test::CountingSelection::FULL);
+        EXPECT_EQ(sstats.extractors, 4);
+        EXPECT_EQ(sstats.fetches, sequence.size() * 4);
+        EXPECT_LT(sstats.elements, dstats.elements * 4);
+
+        // Nothing is recorded for the other oracle mode.
+        EXPECT_EQ(wrapped.statistics(false, !options.use_oracle, tatami_test::CountingSelection::FULL).fetches, 0);
+        EXPECT_EQ(wrapped.statistics(true, !options.use_oracle, tatami_test::CountingSelection::FULL).fetches, 0);
+
+        auto total = wrapped.statistics();
+        EXPECT_EQ(total.extractors, 5);
+        EXPECT_EQ(total.fetches, sequence.size() * 5);
+
+        auto per_index = wrapped.fetches_per_index(options.use_row);
+        for (auto i : sequence) {
+            EXPECT_EQ(per_index[i], 5);
+        }
+        auto other = wrapped.fetches_per_index(!options.use_row);
+        EXPECT_EQ(other, std::vector<size_t>(other.size()));
+    }
+
+    wrapped.reset();
+    EXPECT_EQ(wrapped.statistics().fetches, 0);
+    tatami_test::test_block_access(wrapped, *mat, 0.2, 0.5, options);
+    {
+        auto dstats = wrapped.statistics(false, options.use_oracle, tatami_test::CountingSelection::BLOCK);
+        EXPECT_EQ(dstats.fetches, sequence.size());
+        EXPECT_EQ(dstats.elements, sequence.size() * static_cast<size_t>(extent * 0.5));
+        EXPECT_EQ(wrapped.statistics(false, options.use_oracle, tatami_test::CountingSelection::FULL).fetches, 0);
+        EXPECT_EQ(wrapped.statistics(false, !options.use_oracle, tatami_test::CountingSelection::BLOCK).fetches, 0);
+        EXPECT_EQ(wrapped.statistics(true, !options.use_oracle, tatami_test::CountingSelection::BLOCK).fetches, 0);
+    }
+
+    wrapped.reset();
+    tatami_test::test_indexed_access(wrapped, *mat, 0.3, 0.4, options);
+    {
+        auto dstats = wrapped.statistics(false, options.use_oracle, tatami_test::CountingSelection::INDEX);
+        EXPECT_EQ(dstats.fetches, sequence.size());
+        EXPECT_LT(dstats.elements, sequence.size() * extent);
+        for (bool sparse : { false, true }) {
+            EXPECT_EQ(wrapped.statistics(sparse, options.use_oracle, tatami_test::CountingSelection::BLOCK).fetches, 0);
+            EXPECT_EQ(wrapped.statistics(sparse, !options.use_oracle, tatami_test::CountingSelection::INDEX).fetches, 0);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CountingWrapper,
+    CountingWrapperTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(CountingWrapper, Parallel) {
+    int NR = 91, NC = 73;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    tatami_test::CountingWrapper<double, int> wrapped(mat);
+    tatami_test::TestAccessOptions options;
+    options.num_threads = 3;
+    tatami_test::test_full_access(wrapped, *mat, options);
+
+    auto total = wrapped.statistics();
+    EXPECT_EQ(total.extractors, 15);
+    EXPECT_EQ(total.fetches, static_cast<size_t>(NR) * 5);
+    EXPECT_EQ(wrapped.fetches_per_index(true), std::vector<size_t>(NR, 5));
+}
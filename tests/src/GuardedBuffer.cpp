@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "tatami_test/GuardedBuffer.hpp"
+
+#include <numeric>
+#include <cstdint>
+
+TEST(GuardedBuffer, Basic) {
+    tatami_test::GuardedBuffer<double> buffer(123);
+    EXPECT_EQ(buffer.size(), 123);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % alignof(double), 0);
+
+    std::iota(buffer.data(), buffer.data() + buffer.size(), 0);
+    EXPECT_EQ(buffer.data()[0], 0);
+    EXPECT_EQ(buffer.data()[122], 122);
+    EXPECT_TRUE(buffer.intact());
+
+    // Moving transfers ownership.
+    tatami_test::GuardedBuffer<double> moved(std::move(buffer));
+    EXPECT_EQ(moved.size(), 123);
+    EXPECT_EQ(moved.data()[122], 122);
+    EXPECT_EQ(buffer.size(), 0);
+
+    tatami_test::GuardedBuffer<int> empty(0);
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_TRUE(empty.intact());
+}
+
+TEST(GuardedBuffer, Underrun) {
+    tatami_test::GuardedBuffer<int> buffer(10);
+    buffer.data()[-1] = 1;
+    EXPECT_FALSE(buffer.intact());
+}
+
+TEST(GuardedBuffer, Overrun) {
+    if (!tatami_test::guard_pages_supported()) {
+        return;
+    }
+
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH({
+        tatami_test::GuardedBuffer<int> buffer(10);
+        volatile int* ptr = buffer.data();
+        ptr[10] = 1;
+    }, "");
+}
@@ -0,0 +1,68 @@
+#include "tatami_test/LatencyWrapper.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include <chrono>
+
+class LatencyWrapperTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(LatencyWrapperTest, Parametrized) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+
+    size_t NR = 50, NC = 30;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, simulated, true);
+
+    tatami_test::LatencyWrapperOptions lopt;
+    lopt.per_fetch = 100;
+    lopt.per_element = 1;
+    lopt.jitter = 0.5;
+    lopt.busy_wait = true;
+    tatami_test::LatencyWrapper<double, int> wrapped(mat, lopt);
+
+    tatami_test::test_full_access(wrapped, *mat, options);
+    tatami_test::test_block_access(wrapped, *mat, 0.17, 0.3, options);
+    tatami_test::test_indexed_access(wrapped, *mat, 0.05, 0.2, options);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LatencyWrapper,
+    LatencyWrapperTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(LatencyWrapper, Timing) {
+    int NR = 20, NC = 10;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, simulated, true);
+    EXPECT_FALSE(mat->uses_oracle(true));
+
+    tatami_test::LatencyWrapperOptions lopt;
+    lopt.per_fetch = 2e6; // 2 ms.
+    lopt.oracle_batch = 10;
+    tatami_test::LatencyWrapper<double, int> wrapped(mat, lopt);
+    EXPECT_TRUE(wrapped.uses_oracle(true));
+
+    std::vector<double> buffer(NC);
+    auto myopic_time = [&]() {
+        auto ext = wrapped.dense_row();
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < NR; ++r) {
+            ext->fetch(r, buffer.data());
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }();
+    EXPECT_GE(myopic_time, NR * 2e-3);
+
+    auto oracular_time = [&]() {
+        auto ext = wrapped.dense_row(std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR));
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < NR; ++r) {
+            ext->fetch(buffer.data());
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }();
+    EXPECT_GE(oracular_time, 2 * 2e-3);
+    EXPECT_LT(oracular_time, myopic_time);
+}
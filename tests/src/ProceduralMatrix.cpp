@@ -0,0 +1,110 @@
+#include "tatami_test/ProceduralMatrix.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami/tatami.hpp"
+
+#include <cstdint>
+
+static std::vector<double> materialize(const tatami::Matrix<double, int>& mat) {
+    auto NR = mat.nrow(), NC = mat.ncol();
+    std::vector<double> output(static_cast<size_t>(NR) * static_cast<size_t>(NC));
+    auto ext = mat.dense_row();
+    for (int r = 0; r < NR; ++r) {
+        auto ptr = ext->fetch(r, output.data() + static_cast<size_t>(r) * NC);
+        tatami::copy_n(ptr, NC, output.data() + static_cast<size_t>(r) * NC);
+    }
+    return output;
+}
+
+class ProceduralMatrixTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(ProceduralMatrixTest, Parametrized) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+
+    int NR = 98, NC = 151;
+    tatami_test::ProceduralMatrixOptions popt;
+    popt.density = 0.2;
+    tatami_test::ProceduralMatrix<double, int> mat(NR, NC, popt);
+    EXPECT_TRUE(mat.is_sparse());
+
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, materialize(mat), true);
+
+    tatami_test::test_full_access(mat, ref, options);
+    tatami_test::test_block_access(mat, ref, 0.1, 0.6, options);
+    tatami_test::test_indexed_access(mat, ref, 0.2, 0.3, options);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ProceduralMatrix,
+    ProceduralMatrixTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(ProceduralMatrix, Basic) {
+    tatami_test::ProceduralMatrixOptions popt;
+    popt.lower = -2;
+    popt.upper = 3;
+    popt.density = 0.3;
+    tatami_test::ProceduralMatrix<double, int> mat(50, 80, popt);
+    auto values = materialize(mat);
+
+    size_t nnz = 0;
+    for (auto v : values) {
+        EXPECT_GE(v, -2);
+        EXPECT_LE(v, 3);
+        nnz += (v != 0);
+    }
+    EXPECT_GT(nnz, values.size() * 0.2);
+    EXPECT_LT(nnz, values.size() * 0.4);
+
+    // Columns are consistent with rows.
+    auto cext = mat.dense_column();
+    std::vector<double> buffer(50);
+    auto cptr = cext->fetch(7, buffer.data());
+    for (int r = 0; r < 50; ++r) {
+        EXPECT_EQ(cptr[r], values[r * 80 + 7]);
+    }
+
+    // Different seeds give different results.
+    popt.seed = 42;
+    tatami_test::ProceduralMatrix<double, int> mat2(50, 80, popt);
+    EXPECT_NE(values, materialize(mat2));
+
+    // Fully dense matrices are handled correctly.
+    popt.density = 1;
+    tatami_test::ProceduralMatrix<double, int> mat3(50, 80, popt);
+    EXPECT_FALSE(mat3.is_sparse());
+    for (auto v : materialize(mat3)) {
+        EXPECT_NE(v, 0);
+    }
+}
+
+TEST(ProceduralMatrix, Giant) {
+    // No memory is allocated for the matrix itself, so we can test very large dimensions.
+    int64_t NR = 10000000000, NC = 3000000000;
+    tatami_test::ProceduralMatrix<double, int64_t> mat(NR, NC, tatami_test::ProceduralMatrixOptions());
+    EXPECT_EQ(mat.nrow(), NR);
+    EXPECT_EQ(mat.ncol(), NC);
+
+    int64_t start = NC - 1000, len = 1000;
+    auto dext = mat.dense_row(start, len);
+    auto sext = mat.sparse_row(start, len);
+    std::vector<double> dbuffer(len), vbuffer(len);
+    std::vector<int64_t> ibuffer(len);
+
+    int64_t row = NR - 5;
+    auto dptr = dext->fetch(row, dbuffer.data());
+    auto range = sext->fetch(row, vbuffer.data(), ibuffer.data());
+    EXPECT_GT(range.number, 0);
+
+    std::vector<double> expanded(len);
+    for (int64_t i = 0; i < range.number; ++i) {
+        EXPECT_GE(range.index[i], start);
+        expanded[range.index[i] - start] = range.value[i];
+    }
+    EXPECT_EQ(expanded, std::vector<double>(dptr, dptr + len));
+
+    // Consistent with column access.
+    auto cext = mat.dense_column(static_cast<int64_t>(row), static_cast<int64_t>(1));
+    double single;
+    EXPECT_EQ(*(cext->fetch(NC - 1, &single)), dptr[len - 1]);
+}
@@ -0,0 +1,60 @@
+#include "tatami_test/TracingOracle.hpp"
+#include "tatami_test/ChunkedWrapper.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+
+TEST(TracingOracle, Basic) {
+    auto inner = std::make_shared<tatami::ConsecutiveOracle<int> >(10, 20);
+    tatami_test::TracingOracle<int> oracle(inner);
+    EXPECT_EQ(oracle.total(), 20);
+    EXPECT_EQ(oracle.peak_depth(), 0);
+
+    EXPECT_EQ(oracle.get(0), 10);
+    EXPECT_EQ(oracle.peak_depth(), 0);
+    EXPECT_EQ(oracle.get(5), 15);
+    EXPECT_EQ(oracle.peak_depth(), 5);
+
+    oracle.set_position(4);
+    EXPECT_EQ(oracle.get(7), 17);
+    EXPECT_EQ(oracle.peak_depth(), 5);
+    EXPECT_EQ(oracle.get(12), 22);
+    EXPECT_EQ(oracle.peak_depth(), 8);
+
+    // Requests for earlier predictions don't affect the depth.
+    EXPECT_EQ(oracle.get(1), 11);
+    EXPECT_EQ(oracle.peak_depth(), 8);
+
+    EXPECT_EQ(oracle.gets(), 5);
+    EXPECT_EQ(oracle.out_of_range(), 0);
+    oracle.get(20);
+    EXPECT_EQ(oracle.out_of_range(), 1);
+}
+
+TEST(TracingOracle, TestAccess) {
+    int NR = 100, NC = 50;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+
+    // Each slab spans 10 rows and the cache holds 4 slabs,
+    // so the oracle is read up to 40 rows ahead before encountering a slab that doesn't fit.
+    tatami_test::ChunkedWrapperOptions copt;
+    copt.chunk_nrow = 10;
+    copt.chunk_ncol = 10;
+    copt.cache_size = 20;
+    tatami_test::ChunkedWrapper<double, int> wrapped(mat, copt);
+
+    tatami_test::TestAccessOptions options;
+    options.use_oracle = true;
+    options.max_prefetch_depth = 40;
+    tatami_test::test_full_access(wrapped, *mat, options);
+
+    options.max_prefetch_depth = 39;
+    EXPECT_NONFATAL_FAILURE(tatami_test::test_full_access(wrapped, *mat, options), "prefetches too far ahead");
+
+    // Without prefetching, the depth is always zero.
+    options.max_prefetch_depth = 0;
+    tatami_test::test_full_access(*mat, *mat, options);
+}
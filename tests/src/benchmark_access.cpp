@@ -0,0 +1,93 @@
+#include "tatami_test/benchmark_access.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+static void check_consistency(const tatami_test::BenchmarkAccessResult& res, size_t expected_fetches, size_t extent) {
+    EXPECT_EQ(res.dense.fetches, expected_fetches);
+    EXPECT_EQ(res.dense.elements, expected_fetches * extent);
+    EXPECT_EQ(res.dense.bytes, res.dense.elements * sizeof(double));
+
+    EXPECT_EQ(res.sparse.fetches, expected_fetches);
+    EXPECT_LE(res.sparse.elements, res.dense.elements);
+    EXPECT_EQ(res.sparse.bytes, res.sparse.elements * (sizeof(double) + sizeof(int)));
+
+    EXPECT_EQ(res.sparse_index.elements, res.sparse.elements);
+    EXPECT_EQ(res.sparse_index.bytes, res.sparse.elements * sizeof(int));
+    EXPECT_EQ(res.sparse_value.elements, res.sparse.elements);
+    EXPECT_EQ(res.sparse_value.bytes, res.sparse.elements * sizeof(double));
+    EXPECT_EQ(res.sparse_count.elements, res.sparse.elements);
+    EXPECT_EQ(res.sparse_count.bytes, 0);
+
+    for (const auto* timing : { &res.dense, &res.sparse, &res.sparse_index, &res.sparse_value, &res.sparse_count }) {
+        EXPECT_GE(timing->seconds, 0);
+        EXPECT_GE(timing->ns_per_fetch(), 0);
+        EXPECT_GE(timing->ns_per_element(), 0);
+        EXPECT_GE(timing->bytes_per_second(), 0);
+    }
+}
+
+class BenchmarkAccessTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(BenchmarkAccessTest, Basic) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 67, NC = 152;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+    size_t extent = (options.use_row ? NC : NR);
+
+    auto full = tatami_test::benchmark_full_access(*mat, options);
+    check_consistency(full, sequence.size(), extent);
+    EXPECT_GT(full.sparse.elements, 0);
+
+    auto block = tatami_test::benchmark_block_access(*mat, 0.2, 0.5, options);
+    check_consistency(block, sequence.size(), static_cast<size_t>(extent * 0.5));
+
+    auto indexed = tatami_test::benchmark_indexed_access(*mat, 0.1, 0.4, options);
+    EXPECT_LT(indexed.dense.elements, full.dense.elements);
+    check_consistency(indexed, sequence.size(), indexed.dense.elements / std::max(static_cast<size_t>(1), sequence.size()));
+}
+
+TEST(BenchmarkAccess, Repeats) {
+    int NR = 67, NC = 152;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    tatami_test::TestAccessOptions options;
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    tatami_test::BenchmarkAccessOptions bopt;
+    bopt.repeats = 5;
+    auto repeated = tatami_test::benchmark_full_access(*mat, options, bopt);
+    check_consistency(repeated, sequence.size(), NC);
+
+    // Non-positive repeats are treated as a single pass.
+    bopt.repeats = 0;
+    auto single = tatami_test::benchmark_full_access(*mat, options, bopt);
+    check_consistency(single, sequence.size(), NC);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BenchmarkAccess,
+    BenchmarkAccessTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(BenchmarkAccess, CostHierarchy) {
+    tatami_test::BenchmarkAccessResult res;
+    res.sparse.seconds = 4;
+    res.sparse_index.seconds = 2;
+    res.sparse_value.seconds = 3;
+    res.sparse_count.seconds = 1;
+    EXPECT_TRUE(tatami_test::check_sparse_cost_hierarchy(res));
+
+    // Within tolerance.
+    res.sparse_count.seconds = 2.1;
+    EXPECT_TRUE(tatami_test::check_sparse_cost_hierarchy(res, 1.1));
+
+    res.sparse_count.seconds = 1;
+    res.sparse_value.seconds = 5;
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_sparse_cost_hierarchy(res), "value-only extraction (5 s) is slower than full sparse extraction (4 s)");
+    EXPECT_FALSE(tatami_test::check_sparse_cost_hierarchy(res, 1.2, /* fail = */ false));
+    EXPECT_TRUE(tatami_test::check_sparse_cost_hierarchy(res, 1.5));
+}
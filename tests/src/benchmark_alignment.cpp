@@ -0,0 +1,146 @@
+#include "tatami_test/benchmark_alignment.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami_test/simulate_compressed_sparse.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+class BenchmarkAlignmentTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(BenchmarkAlignmentTest, Full) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 53, NC = 71;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
+    auto contents = manual_densify(NR, NC, simulated);
+    auto dense = std::make_shared<tatami::DenseMatrix<double, int, decltype(contents)> >(NR, NC, std::move(contents), true);
+    auto sparse = create_sparse_matrix(NR, NC, std::move(simulated));
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+    size_t extent = (options.use_row ? NC : NR);
+
+    tatami_test::BenchmarkAlignmentOptions aopt;
+    aopt.repeats = 1;
+    auto res = tatami_test::benchmark_full_alignment(*dense, *sparse, options, aopt);
+    ASSERT_EQ(res.size(), 8);
+    for (size_t i = 0; i < res.size(); ++i) {
+        EXPECT_EQ(res[i].offset, i);
+        EXPECT_EQ(res[i].fetches, sequence.size());
+        EXPECT_EQ(res[i].elements, sequence.size() * extent);
+        EXPECT_GE(res[i].elements_per_second(), 0);
+    }
+    EXPECT_EQ(res[0].alignment, 64);
+    EXPECT_EQ(res[1].alignment, 8);
+    EXPECT_EQ(res[2].alignment, 16);
+    EXPECT_EQ(res[4].alignment, 32);
+
+    // Row access to a row-major dense matrix returns a pointer to its internal storage.
+    for (const auto& point : res) {
+        if (options.use_row) {
+            EXPECT_EQ(point.own_pointer_fraction(), 1);
+        } else {
+            EXPECT_EQ(point.own_pointer_fraction(), 0);
+        }
+    }
+
+    aopt.sparse = true;
+    aopt.offsets = std::vector<size_t>{ 0, 3 };
+    auto sres = tatami_test::benchmark_full_alignment(*sparse, *dense, options, aopt);
+    ASSERT_EQ(sres.size(), 2);
+    EXPECT_EQ(sres[1].offset, 3);
+    EXPECT_EQ(sres[0].index_alignment, 64);
+    EXPECT_EQ(sres[1].index_alignment, 4); // offset of 3 ints.
+    EXPECT_EQ(sres[0].elements, sres[1].elements);
+    EXPECT_LT(sres[0].elements, sequence.size() * extent);
+}
+
+TEST_P(BenchmarkAlignmentTest, Block) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 53, NC = 71;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
+    auto contents = manual_densify(NR, NC, simulated);
+    auto dense = std::make_shared<tatami::DenseMatrix<double, int, decltype(contents)> >(NR, NC, std::move(contents), true);
+    auto sparse = create_sparse_matrix(NR, NC, std::move(simulated));
+    tatami_test::BenchmarkAlignmentOptions aopt;
+    aopt.offsets = std::vector<size_t>{ 0, 1, 5 };
+    aopt.repeats = 1;
+
+    auto res = tatami_test::benchmark_block_alignment(*dense, *sparse, 0.2, 0.5, options, aopt);
+    ASSERT_EQ(res.size(), 3);
+    EXPECT_EQ(res[2].offset, 5);
+
+    aopt.sparse = true;
+    auto sres = tatami_test::benchmark_block_alignment(*sparse, *dense, 0.2, 0.5, options, aopt);
+    ASSERT_EQ(sres.size(), 3);
+    for (const auto& point : sres) {
+        EXPECT_EQ(point.elements, sres[0].elements);
+    }
+}
+
+TEST_P(BenchmarkAlignmentTest, Indexed) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 53, NC = 71;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
+    auto contents = manual_densify(NR, NC, simulated);
+    auto dense = std::make_shared<tatami::DenseMatrix<double, int, decltype(contents)> >(NR, NC, std::move(contents), true);
+    auto sparse = create_sparse_matrix(NR, NC, std::move(simulated));
+    tatami_test::BenchmarkAlignmentOptions aopt;
+    aopt.offsets = std::vector<size_t>{ 0, 7 };
+    aopt.repeats = 1;
+
+    auto res = tatami_test::benchmark_indexed_alignment(*dense, *sparse, 0.1, 0.4, options, aopt);
+    ASSERT_EQ(res.size(), 2);
+
+    aopt.sparse = true;
+    auto sres = tatami_test::benchmark_indexed_alignment(*sparse, *dense, 0.1, 0.4, options, aopt);
+    ASSERT_EQ(sres.size(), 2);
+    EXPECT_EQ(sres[0].elements, sres[1].elements);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BenchmarkAlignment,
+    BenchmarkAlignmentTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(BenchmarkAlignment, IntegerOffsets) {
+    int NR = 10, NC = 20;
+    auto contents = tatami_test::simulate_vector<int>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseMatrix<int, int, decltype(contents)> mat(NR, NC, contents, false);
+    tatami::DenseMatrix<int, int, decltype(contents)> ref(NR, NC, std::move(contents), false);
+
+    tatami_test::TestAccessOptions options;
+    auto res = tatami_test::benchmark_full_alignment(mat, ref, options, tatami_test::BenchmarkAlignmentOptions());
+    ASSERT_EQ(res.size(), 16); // all offsets within a 64-byte boundary.
+    EXPECT_EQ(res[1].alignment, 4);
+    EXPECT_EQ(res[15].offset, 15);
+}
+
+static void test_alignment_mismatch(bool sparse) {
+    int NR = 10, NC = 20;
+    std::vector<double> contents(NR * NC, 1);
+    tatami::DenseMatrix<double, int, decltype(contents)> mat(NR, NC, contents, true);
+    contents[5] = 2;
+    tatami::DenseMatrix<double, int, decltype(contents)> ref(NR, NC, std::move(contents), true);
+
+    tatami_test::BenchmarkAlignmentOptions aopt;
+    aopt.offsets = std::vector<size_t>{ 1 };
+    aopt.repeats = 1;
+    aopt.sparse = sparse;
+    tatami_test::benchmark_full_alignment(mat, ref, tatami_test::TestAccessOptions(), aopt);
+}
+
+TEST(BenchmarkAlignment, Mismatch) {
+    EXPECT_NONFATAL_FAILURE(test_alignment_mismatch(false), "dense retrieval into offset buffers");
+    EXPECT_NONFATAL_FAILURE(test_alignment_mismatch(true), "sparse retrieval into offset buffers");
+}
+
+TEST(BenchmarkAlignment, Dimensions) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(10, 20, std::vector<double>(200), true);
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(20, 10, std::vector<double>(200), true);
+    std::vector<tatami_test::BenchmarkAlignmentPoint> res;
+    EXPECT_NONFATAL_FAILURE(
+        res = tatami_test::benchmark_full_alignment(mat, ref, tatami_test::TestAccessOptions(), tatami_test::BenchmarkAlignmentOptions()),
+        "same dimensions"
+    );
+    EXPECT_TRUE(res.empty());
+}
@@ -0,0 +1,109 @@
+#include "tatami_test/benchmark_scaling.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/LatencyWrapper.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+
+static void check_structure(const tatami_test::BenchmarkScalingResult& res, const tatami_test::BenchmarkScalingOptions& sopt, size_t expected_fetches) {
+    ASSERT_EQ(res.points.size(), sopt.sizes.size());
+    EXPECT_EQ(res.full.fetches, expected_fetches);
+    for (size_t i = 0; i < res.points.size(); ++i) {
+        const auto& p = res.points[i];
+        EXPECT_EQ(p.size, sopt.sizes[i]);
+        EXPECT_EQ(p.timing.fetches, expected_fetches);
+        if (!sopt.sparse) {
+            EXPECT_EQ(p.timing.elements, p.number * expected_fetches);
+        }
+    }
+}
+
+class BenchmarkScalingTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(BenchmarkScalingTest, Basic) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 31, NC = 57;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    tatami_test::BenchmarkScalingOptions sopt;
+    sopt.repeats = 1;
+    sopt.relative_start = 0.1;
+    sopt.sizes = std::vector<double>{ 0.1, 0.3, 0.5 };
+
+    auto block = tatami_test::benchmark_block_scaling(*mat, options, sopt);
+    check_structure(block, sopt, sequence.size());
+    size_t extent = (options.use_row ? NC : NR);
+    for (size_t i = 0; i < sopt.sizes.size(); ++i) {
+        EXPECT_EQ(block.points[i].number, static_cast<size_t>(extent * sopt.sizes[i]));
+    }
+
+    auto indexed = tatami_test::benchmark_indexed_scaling(*mat, options, sopt);
+    check_structure(indexed, sopt, sequence.size());
+
+    sopt.sparse = true;
+    auto sblock = tatami_test::benchmark_block_scaling(*mat, options, sopt);
+    check_structure(sblock, sopt, sequence.size());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BenchmarkScaling,
+    BenchmarkScalingTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(BenchmarkScaling, Latency) {
+    size_t NR = 31, NC = 57;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    tatami_test::TestAccessOptions options;
+    tatami_test::BenchmarkScalingOptions sopt;
+    sopt.sizes = std::vector<double>{ 0.2, 0.5, 0.8 };
+
+    // Cost proportional to the number of elements scales correctly.
+    {
+        tatami_test::LatencyWrapperOptions lopt;
+        lopt.per_element = 500;
+        lopt.busy_wait = true;
+        tatami_test::LatencyWrapper<double, int> wrapped(mat, lopt);
+
+        auto res = tatami_test::benchmark_block_scaling(wrapped, options, sopt);
+        EXPECT_GT(res.slope, 0);
+        EXPECT_TRUE(tatami_test::check_access_scaling(res, 0.5, /* fail = */ false));
+    }
+
+    // Fixed cost per fetch does not scale.
+    {
+        tatami_test::LatencyWrapperOptions lopt;
+        lopt.per_fetch = 20000;
+        lopt.busy_wait = true;
+        tatami_test::LatencyWrapper<double, int> wrapped(mat, lopt);
+
+        auto res = tatami_test::benchmark_indexed_scaling(wrapped, options, sopt);
+        EXPECT_FALSE(tatami_test::check_access_scaling(res, 0.5, /* fail = */ false));
+    }
+}
+
+TEST(BenchmarkScaling, Fit) {
+    tatami_test::BenchmarkScalingResult res;
+    for (size_t n : { 10, 20, 40 }) {
+        tatami_test::BenchmarkScalingPoint point;
+        point.number = n;
+        point.timing.fetches = 1000;
+        point.timing.seconds = (50 + 2.0 * n) * 1e-6; // 50 ns fixed + 2 ns per element, per fetch.
+        res.points.push_back(point);
+    }
+    res.full.fetches = 1000;
+    res.full.seconds = (50 + 2.0 * 100) * 1e-6;
+
+    tatami_test::internal::fit_scaling(res);
+    EXPECT_NEAR(res.slope, 2, 1e-8);
+    EXPECT_NEAR(res.intercept, 50, 1e-8);
+    EXPECT_NEAR(res.fixed_fraction(), 0.2, 1e-8);
+    EXPECT_TRUE(tatami_test::check_access_scaling(res));
+
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_access_scaling(res, 0.1), "does not scale with subset size");
+    EXPECT_FALSE(tatami_test::check_access_scaling(res, 0.1, /* fail = */ false));
+}
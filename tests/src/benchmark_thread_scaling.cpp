@@ -0,0 +1,85 @@
+#include "tatami_test/benchmark_thread_scaling.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami/tatami.hpp"
+
+#include <sstream>
+
+#include "utils.h"
+
+class BenchmarkThreadScalingTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(BenchmarkThreadScalingTest, Basic) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 87, NC = 56;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+    size_t extent = (options.use_row ? NC : NR);
+
+    tatami_test::BenchmarkThreadScalingOptions sopt;
+    sopt.num_threads = std::vector<int>{ 1, 2, 3 };
+    auto res = tatami_test::benchmark_thread_scaling(*mat, options, sopt);
+    ASSERT_EQ(res.size(), 3);
+    for (size_t i = 0; i < res.size(); ++i) {
+        EXPECT_EQ(res[i].num_threads, sopt.num_threads[i]);
+        EXPECT_GE(res[i].used_threads, 1);
+        EXPECT_LE(res[i].used_threads, res[i].num_threads);
+        EXPECT_EQ(res[i].fetches, sequence.size());
+        EXPECT_EQ(res[i].elements, sequence.size() * extent);
+        EXPECT_GE(res[i].efficiency, 0);
+    }
+    EXPECT_DOUBLE_EQ(res[0].efficiency, 1);
+
+    // Sparse extraction only reports the non-zeros, which should be the same regardless of the number of threads.
+    sopt.sparse = true;
+    sopt.repeats = 2;
+    auto sres = tatami_test::benchmark_thread_scaling(*mat, options, sopt);
+    ASSERT_EQ(sres.size(), 3);
+    for (const auto& point : sres) {
+        EXPECT_EQ(point.fetches, sequence.size());
+        EXPECT_EQ(point.elements, sres[0].elements);
+        EXPECT_LT(point.elements, sequence.size() * extent);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BenchmarkThreadScaling,
+    BenchmarkThreadScalingTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(BenchmarkThreadScaling, FewerJobsThanThreads) {
+    // Only 3 rows, so at most 3 threads can be used.
+    auto mat = simulate_sparse_matrix(3, 50);
+
+    tatami_test::BenchmarkThreadScalingOptions sopt;
+    sopt.num_threads = std::vector<int>{ 1, 8 };
+    auto res = tatami_test::benchmark_thread_scaling(*mat, tatami_test::TestAccessOptions(), sopt);
+    ASSERT_EQ(res.size(), 2);
+    EXPECT_EQ(res[0].used_threads, 1);
+    EXPECT_EQ(res[1].num_threads, 8);
+    EXPECT_EQ(res[1].used_threads, 3);
+}
+
+TEST(BenchmarkThreadScaling, Csv) {
+    std::vector<tatami_test::BenchmarkThreadScalingPoint> res(2);
+    res[0].num_threads = 1;
+    res[0].used_threads = 1;
+    res[0].fetches = 100;
+    res[0].elements = 1000;
+    res[0].seconds = 2;
+    res[0].efficiency = 1;
+    res[1].num_threads = 2;
+    res[1].used_threads = 2;
+    res[1].fetches = 100;
+    res[1].elements = 1000;
+    res[1].seconds = 1.25;
+    res[1].efficiency = 0.8;
+
+    std::ostringstream out;
+    tatami_test::write_thread_scaling_csv(res, out);
+    EXPECT_EQ(out.str(),
+        "num_threads,used_threads,fetches,elements,seconds,fetches_per_second,elements_per_second,efficiency\n"
+        "1,1,100,1000,2,50,500,1\n"
+        "2,2,100,1000,1.25,80,800,0.8\n"
+    );
+}
@@ -0,0 +1,76 @@
+#include "tatami_test/benchmark_unsorted_access.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/ReversedIndicesWrapper.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+static void check_consistency(const tatami_test::BenchmarkUnsortedAccessResult& res, size_t expected_fetches) {
+    EXPECT_EQ(res.ordered.fetches, expected_fetches);
+    EXPECT_EQ(res.unordered.fetches, expected_fetches);
+    EXPECT_EQ(res.ordered.elements, res.unordered.elements);
+    EXPECT_EQ(res.ordered.bytes, res.unordered.bytes);
+    EXPECT_GE(res.ratio(), 0);
+}
+
+class BenchmarkUnsortedAccessTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(BenchmarkUnsortedAccessTest, Basic) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 73, NC = 121;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    std::shared_ptr<tatami::Matrix<double, int> > reversed(new tatami_test::ReversedIndicesWrapper<double, int>(mat));
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    for (const auto& m : { mat, reversed }) {
+        auto full = tatami_test::benchmark_unsorted_full_access(*m, options);
+        check_consistency(full, sequence.size());
+        EXPECT_GT(full.ordered.elements, 0);
+
+        auto block = tatami_test::benchmark_unsorted_block_access(*m, 0.2, 0.5, options);
+        check_consistency(block, sequence.size());
+        EXPECT_LE(block.ordered.elements, full.ordered.elements);
+
+        auto indexed = tatami_test::benchmark_unsorted_indexed_access(*m, 0.1, 0.4, options);
+        check_consistency(indexed, sequence.size());
+        EXPECT_LE(indexed.ordered.elements, full.ordered.elements);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BenchmarkUnsortedAccess,
+    BenchmarkUnsortedAccessTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(BenchmarkUnsortedAccess, Repeats) {
+    int NR = 73, NC = 121;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    tatami_test::TestAccessOptions options;
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    tatami_test::BenchmarkAccessOptions bopt;
+    bopt.repeats = 4;
+    check_consistency(tatami_test::benchmark_unsorted_full_access(*mat, options, bopt), sequence.size());
+
+    // Non-positive repeats are treated as a single pass.
+    bopt.repeats = 0;
+    check_consistency(tatami_test::benchmark_unsorted_indexed_access(*mat, 0.1, 0.4, options, bopt), sequence.size());
+}
+
+TEST(BenchmarkUnsortedAccess, CheckRatio) {
+    tatami_test::BenchmarkUnsortedAccessResult res;
+    res.ordered.seconds = 1;
+    res.unordered.seconds = 0.8;
+    EXPECT_DOUBLE_EQ(res.ratio(), 0.8);
+    EXPECT_TRUE(tatami_test::check_unsorted_access_ratio(res));
+
+    res.unordered.seconds = 2;
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_unsorted_access_ratio(res, 1.5), "2x slower than ordered extraction");
+    EXPECT_FALSE(tatami_test::check_unsorted_access_ratio(res, 1.5, /* fail = */ false));
+    EXPECT_TRUE(tatami_test::check_unsorted_access_ratio(res, 3));
+
+    res.ordered.seconds = 0;
+    EXPECT_EQ(res.ratio(), 0);
+}
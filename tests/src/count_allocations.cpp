@@ -0,0 +1,77 @@
+// Installing the allocation hooks for the entire test executable.
+#define TATAMI_TEST_DEFINE_ALLOCATION_HOOKS
+#include "tatami_test/count_allocations.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+
+#include <thread>
+
+TEST(CountAllocations, Hooks) {
+    EXPECT_TRUE(tatami_test::allocation_tracking_enabled());
+
+    auto before = tatami_test::current_allocations();
+    auto ptr = std::make_unique<std::vector<double> >(100);
+    auto after = tatami_test::current_allocations();
+    EXPECT_EQ(after.count - before.count, 2);
+    EXPECT_EQ(after.bytes - before.bytes, sizeof(std::vector<double>) + 100 * sizeof(double));
+
+    // Allocations in other threads are not counted for the current thread, but are counted globally.
+    before = tatami_test::current_allocations();
+    auto global_before = tatami_test::global_allocations();
+    std::thread worker([]() -> void {
+        std::vector<int> foo(1000);
+    });
+    worker.join();
+    after = tatami_test::current_allocations();
+    auto global_after = tatami_test::global_allocations();
+    EXPECT_LT(after.bytes - before.bytes, 1000 * sizeof(int));
+    EXPECT_GE(global_after.bytes - global_before.bytes, 1000 * sizeof(int) + (after.bytes - before.bytes));
+    EXPECT_GT(global_after.count - global_before.count, after.count - before.count);
+}
+
+class CountAllocationsTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(CountAllocationsTest, Basic) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 45, NC = 61;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto mat = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    auto full = tatami_test::count_full_allocations(*mat, options);
+    EXPECT_EQ(full.dense.fetches, sequence.size());
+    EXPECT_GT(full.dense.construction.count, 0); // at least the extractor itself is allocated.
+    EXPECT_TRUE(tatami_test::check_steady_state_allocations(full));
+
+    auto block = tatami_test::count_block_allocations(*mat, 0.2, 0.5, options);
+    EXPECT_EQ(block.sparse.fetches, sequence.size());
+    EXPECT_TRUE(tatami_test::check_steady_state_allocations(block));
+
+    auto indexed = tatami_test::count_indexed_allocations(*mat, 0.1, 0.3, options, /* warmup = */ 0);
+    EXPECT_EQ(indexed.sparse_count.fetches, sequence.size());
+    EXPECT_TRUE(tatami_test::check_steady_state_allocations(indexed));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CountAllocations,
+    CountAllocationsTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(CountAllocations, SteadyState) {
+    tatami_test::AllocationAccessResult res;
+    res.dense.fetches = 10;
+    res.dense.total.count = 3;
+    res.dense.total.bytes = 300;
+    EXPECT_DOUBLE_EQ(res.dense.allocations_per_fetch(), 0.3);
+    EXPECT_DOUBLE_EQ(res.dense.bytes_per_fetch(), 30);
+    EXPECT_TRUE(tatami_test::check_steady_state_allocations(res));
+
+    res.sparse_value.steady.count = 5;
+    res.sparse_value.steady.bytes = 200;
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_steady_state_allocations(res), "value-only sparse extraction made 5 allocation(s) (200 bytes) after warm-up");
+    EXPECT_FALSE(tatami_test::check_steady_state_allocations(res, /* fail = */ false));
+}
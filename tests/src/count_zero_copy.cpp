@@ -0,0 +1,99 @@
+#include "tatami_test/count_zero_copy.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami_test/simulate_vector.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+class CountZeroCopyTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(CountZeroCopyTest, Dense) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 48, NC = 39;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto row_major = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+    auto sequence = tatami_test::internal::simulate_test_access_sequence(NR, NC, options);
+
+    auto res = tatami_test::count_full_zero_copy(*row_major, options);
+    EXPECT_EQ(res.dense.fetches, sequence.size());
+    EXPECT_EQ(res.sparse.fetches, sequence.size());
+    if (options.use_row) {
+        tatami_test::check_zero_copy(res.dense);
+    } else {
+        EXPECT_EQ(res.dense.zero_copy, 0);
+    }
+
+    // Sparse extraction from a dense matrix always needs to copy the non-zero values.
+    EXPECT_EQ(res.sparse.zero_copy, 0);
+    EXPECT_EQ(res.sparse_index.zero_copy, 0);
+    EXPECT_EQ(res.sparse_value.zero_copy, 0);
+}
+
+TEST_P(CountZeroCopyTest, Transposed) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 48, NC = 39;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto column_major = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NC, NR, std::move(simulated), false);
+    auto transposed = tatami::make_DelayedTranspose<double, int>(column_major);
+
+    auto res = tatami_test::count_full_zero_copy(*transposed, options);
+    if (options.use_row) {
+        tatami_test::check_zero_copy(res.dense);
+    } else {
+        EXPECT_EQ(res.dense.zero_copy, 0);
+    }
+}
+
+TEST_P(CountZeroCopyTest, Subset) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    if (!options.use_row) {
+        return;
+    }
+
+    int NR = 48, NC = 39;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    auto row_major = std::make_shared<tatami::DenseMatrix<double, int, decltype(simulated)> >(NR, NC, std::move(simulated), true);
+
+    // Row access to a column subset should still pass through the pointer to the row-major storage.
+    auto subset = tatami::make_DelayedSubsetBlock<double, int>(row_major, 5, 20, false);
+    auto res = tatami_test::count_full_zero_copy(*subset, options);
+    tatami_test::check_zero_copy(res.dense);
+
+    auto bres = tatami_test::count_block_zero_copy(*row_major, 0.2, 0.5, options);
+    tatami_test::check_zero_copy(bres.dense);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CountZeroCopy,
+    CountZeroCopyTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(CountZeroCopy, Sparse) {
+    int NR = 30, NC = 20;
+    auto mat = simulate_sparse_matrix(NR, NC);
+
+    tatami_test::TestAccessOptions options;
+    auto res = tatami_test::count_indexed_zero_copy(*mat, 0.1, 0.5, options);
+    EXPECT_EQ(res.dense.fetches, NR);
+    EXPECT_EQ(res.dense.zero_copy, 0);
+
+    // The non-zeros in an indexed subset are gathered into the buffers with remapped indices, so nothing is returned from the matrix's own storage.
+    EXPECT_EQ(res.sparse.fetches, NR);
+    EXPECT_EQ(res.sparse.zero_copy, 0);
+    EXPECT_EQ(res.sparse_index.zero_copy, 0);
+    EXPECT_EQ(res.sparse_value.zero_copy, 0);
+}
+
+TEST(CountZeroCopy, Check) {
+    tatami_test::ZeroCopyStatistics stats;
+    EXPECT_TRUE(tatami_test::check_zero_copy(stats)); // no fetches at all.
+
+    stats.fetches = 10;
+    stats.zero_copy = 8;
+    EXPECT_DOUBLE_EQ(stats.fraction(), 0.8);
+    EXPECT_TRUE(tatami_test::check_zero_copy(stats, 0.8));
+    EXPECT_FALSE(tatami_test::check_zero_copy(stats, 1, false));
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_zero_copy(stats), "only 8 out of 10 fetches were zero-copy");
+}
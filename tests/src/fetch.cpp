@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/fetch.hpp"
+#include "tatami/tatami.hpp"
+
+#include "utils.h"
+
+TEST(Fetch, DenseReuse) {
+    int NR = 23, NC = 41;
+    auto mat = simulate_sparse_matrix(NR, NC);
+
+    auto ext = mat->dense_row();
+    auto ext2 = mat->dense_row();
+    std::vector<double> buffer;
+    for (int r = 0; r < NR; ++r) {
+        tatami_test::fetch(*ext, r, NC, buffer);
+        EXPECT_EQ(buffer, tatami_test::fetch(*ext2, r, NC));
+    }
+
+    auto optr = std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR);
+    auto oext = mat->dense_row(optr);
+    for (int r = 0; r < NR; ++r) {
+        auto ptr = buffer.data();
+        tatami_test::fetch(*oext, NC, buffer);
+        EXPECT_EQ(ptr, buffer.data()); // no reallocation.
+        EXPECT_EQ(buffer, tatami_test::fetch(*ext2, r, NC));
+    }
+}
+
+TEST(Fetch, SparseReuse) {
+    int NR = 23, NC = 41;
+    auto mat = simulate_sparse_matrix(NR, NC);
+
+    auto ext = mat->sparse_row();
+    auto ext2 = mat->sparse_row();
+    tatami_test::SparseVector<double, int> buffer;
+    for (int r = 0; r < NR; ++r) {
+        tatami_test::fetch(*ext, r, NC, buffer);
+        auto ref = tatami_test::fetch(*ext2, r, NC);
+        EXPECT_EQ(buffer.value, ref.value);
+        EXPECT_EQ(buffer.index, ref.index);
+    }
+
+    auto optr = std::make_shared<tatami::ConsecutiveOracle<int> >(0, NR);
+    auto oext = mat->sparse_row(optr);
+    for (int r = 0; r < NR; ++r) {
+        auto vptr = buffer.value.data();
+        auto iptr = buffer.index.data();
+        tatami_test::fetch(*oext, NC, buffer);
+        EXPECT_EQ(vptr, buffer.value.data()); // no reallocation.
+        EXPECT_EQ(iptr, buffer.index.data());
+
+        auto ref = tatami_test::fetch(*ext2, r, NC);
+        EXPECT_EQ(buffer.value, ref.value);
+        EXPECT_EQ(buffer.index, ref.index);
+    }
+}
@@ -0,0 +1,92 @@
+// The allocation hooks are already defined in count_allocations.cpp.
+#include "tatami_test/measure_memory.hpp"
+#include "tatami_test/test_access.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+TEST(MeasureMemory, PeakMemory) {
+    ASSERT_TRUE(tatami_test::allocation_tracking_enabled());
+
+    auto peak = tatami_test::measure_peak_memory([]() -> void {
+        std::vector<double> foo(1000);
+        std::vector<double> bar(2000);
+    });
+    EXPECT_GE(peak, 3000 * sizeof(double));
+
+    // Freed memory is not counted in the next measurement.
+    peak = tatami_test::measure_peak_memory([]() -> void {
+        std::vector<double> foo(100);
+    });
+    EXPECT_GE(peak, 100 * sizeof(double));
+    EXPECT_LT(peak, 1000 * sizeof(double));
+
+    // Memory retained by the function is still counted in the live bytes.
+    std::vector<int> retained;
+    auto before = tatami_test::current_live_bytes();
+    tatami_test::measure_peak_memory([&]() -> void {
+        retained.resize(500);
+    });
+    EXPECT_EQ(tatami_test::current_live_bytes() - before, 500 * sizeof(int));
+}
+
+class MeasureMemoryTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(MeasureMemoryTest, Full) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 57, NC = 43;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    auto res = tatami_test::measure_full_memory(*mat, options);
+    EXPECT_EQ(res.extent_bytes, (options.use_row ? NC : NR) * (sizeof(double) + sizeof(int)));
+
+    for (const auto& stats : { res.dense, res.sparse, res.sparse_index, res.sparse_value, res.sparse_count }) {
+        EXPECT_GT(stats.retained, 0); // the extractor itself is on the heap.
+        EXPECT_GE(stats.construction_peak, stats.retained);
+        EXPECT_GE(stats.peak, stats.construction_peak);
+        EXPECT_EQ(stats.leaked, 0);
+    }
+    tatami_test::check_peak_memory(res);
+}
+
+TEST_P(MeasureMemoryTest, Block) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 57, NC = 43;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    auto res = tatami_test::measure_block_memory(*mat, 0.2, 0.5, options);
+    EXPECT_EQ(res.extent_bytes, static_cast<int>((options.use_row ? NC : NR) * 0.5) * (sizeof(double) + sizeof(int)));
+    EXPECT_EQ(res.dense.leaked, 0);
+    EXPECT_EQ(res.sparse.leaked, 0);
+    tatami_test::check_peak_memory(res);
+}
+
+TEST_P(MeasureMemoryTest, Indexed) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    int NR = 57, NC = 43;
+    auto mat = simulate_sparse_matrix(NR, NC);
+    auto res = tatami_test::measure_indexed_memory(*mat, 0.1, 0.3, options);
+    EXPECT_GT(res.extent_bytes, 0);
+    EXPECT_EQ(res.dense.leaked, 0);
+    EXPECT_EQ(res.sparse.leaked, 0);
+    tatami_test::check_peak_memory(res);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    MeasureMemory,
+    MeasureMemoryTest,
+    tatami_test::standard_test_access_options_combinations()
+);
+
+TEST(MeasureMemory, CheckPeakMemory) {
+    tatami_test::MemoryAccessResult res;
+    res.extent_bytes = 100;
+    EXPECT_TRUE(tatami_test::check_peak_memory(res, 10, 0));
+
+    res.sparse_index.peak = 1000;
+    EXPECT_TRUE(tatami_test::check_peak_memory(res, 10, 0));
+
+    res.sparse_index.peak = 1001;
+    EXPECT_FALSE(tatami_test::check_peak_memory(res, 10, 0, false));
+    EXPECT_TRUE(tatami_test::check_peak_memory(res, 10, 1, false));
+    EXPECT_NONFATAL_FAILURE(tatami_test::check_peak_memory(res, 10, 0), "index-only sparse extraction has a peak of 1001 bytes");
+}
@@ -77,3 +77,121 @@ TEST(SimulateCompressedSparse, Basic) {
         EXPECT_NE(res.indptr, res2.indptr);
     }
 }
+
+TEST(SimulateCompressedSparse, SkipAhead) {
+    size_t primary = 50, secondary = 200;
+    tatami_test::SimulateCompressedSparseOptions opt;
+    opt.lower = -5;
+    opt.upper = 5;
+    opt.density = 0.05;
+    opt.skip_ahead = true;
+    auto res = tatami_test::simulate_compressed_sparse<double, int>(primary, secondary, opt);
+
+    EXPECT_EQ(res.indptr.back(), res.data.size());
+    EXPECT_EQ(res.indptr.back(), res.index.size());
+    EXPECT_GT(res.data.size(), 0);
+    EXPECT_LT(res.data.size(), primary * secondary * 0.1);
+
+    for (auto x : res.data) {
+        EXPECT_GE(x, -5);
+        EXPECT_LE(x, 5);
+    }
+
+    for (size_t p = 0; p < primary; ++p) {
+        auto pstart = res.indptr[p], pend = res.indptr[p + 1];
+        for (size_t s = pstart; s < pend; ++s) {
+            EXPECT_GE(res.index[s], 0);
+            EXPECT_LT(res.index[s], secondary);
+            if (s > pstart) {
+                EXPECT_LT(res.index[s - 1], res.index[s]);
+            }
+        }
+    }
+
+    // Same seed gives the same results.
+    auto res2 = tatami_test::simulate_compressed_sparse<double, int>(primary, secondary, opt);
+    EXPECT_EQ(res.data, res2.data);
+    EXPECT_EQ(res.index, res2.index);
+    EXPECT_EQ(res.indptr, res2.indptr);
+
+    opt.seed = 98765;
+    auto res3 = tatami_test::simulate_compressed_sparse<double, int>(primary, secondary, opt);
+    EXPECT_NE(res.index, res3.index);
+
+    // Edge cases for the density.
+    opt.density = 0;
+    auto empty = tatami_test::simulate_compressed_sparse<double, int>(primary, secondary, opt);
+    EXPECT_TRUE(empty.data.empty());
+    EXPECT_EQ(empty.indptr, std::vector<size_t>(primary + 1));
+
+    opt.density = 1;
+    auto full = tatami_test::simulate_compressed_sparse<double, int>(primary, secondary, opt);
+    EXPECT_EQ(full.data.size(), primary * secondary);
+    EXPECT_EQ(full.indptr[1], secondary);
+}
+
+TEST(SimulateCompressedSparse, Parallel) {
+    for (auto skip : { false, true }) {
+        size_t primary = 97, secondary = 120;
+        tatami_test::SimulateCompressedSparseOptions opt;
+        opt.density = 0.2;
+        opt.skip_ahead = skip;
+
+        auto ref = tatami_test::simulate_compressed_sparse_parallel<double, int>(primary, secondary, opt, 1);
+        EXPECT_EQ(ref.indptr.size(), primary + 1);
+        EXPECT_EQ(ref.indptr.back(), ref.data.size());
+        EXPECT_EQ(ref.indptr.back(), ref.index.size());
+        EXPECT_GT(ref.data.size(), 0);
+
+        for (size_t p = 0; p < primary; ++p) {
+            auto pstart = ref.indptr[p], pend = ref.indptr[p + 1];
+            EXPECT_TRUE(std::is_sorted(ref.index.begin() + pstart, ref.index.begin() + pend));
+        }
+
+        // Results are independent of the number of threads.
+        for (int nthreads : { 2, 3, 8, 200 }) {
+            auto res = tatami_test::simulate_compressed_sparse_parallel<double, int>(primary, secondary, opt, nthreads);
+            EXPECT_EQ(ref.data, res.data);
+            EXPECT_EQ(ref.index, res.index);
+            EXPECT_EQ(ref.indptr, res.indptr);
+        }
+
+        opt.seed = 42;
+        auto other = tatami_test::simulate_compressed_sparse_parallel<double, int>(primary, secondary, opt, 4);
+        EXPECT_NE(ref.index, other.index);
+    }
+
+    auto empty = tatami_test::simulate_compressed_sparse_parallel<double, int>(0, 10, tatami_test::SimulateCompressedSparseOptions(), 4);
+    EXPECT_EQ(empty.indptr, std::vector<size_t>(1));
+    EXPECT_TRUE(empty.data.empty());
+}
+
+TEST(SimulateCompressedSparse, Stream) {
+    size_t primary = 33, secondary = 87;
+    tatami_test::SimulateCompressedSparseOptions opt;
+    opt.density = 0.15;
+    opt.skip_ahead = true;
+    auto ref = tatami_test::simulate_compressed_sparse_parallel<double, int>(primary, secondary, opt, 3);
+
+    tatami_test::SimulateCompressedSparseStream<double, int> stream(primary, secondary, opt);
+    EXPECT_EQ(stream.primary(), primary);
+    EXPECT_EQ(stream.secondary(), secondary);
+
+    size_t p = 0;
+    while (stream.next()) {
+        std::vector<double> exp_v(ref.data.begin() + ref.indptr[p], ref.data.begin() + ref.indptr[p + 1]);
+        std::vector<int> exp_i(ref.index.begin() + ref.indptr[p], ref.index.begin() + ref.indptr[p + 1]);
+        EXPECT_EQ(stream.value(), exp_v);
+        EXPECT_EQ(stream.index(), exp_i);
+        ++p;
+        EXPECT_EQ(stream.position(), p);
+    }
+    EXPECT_EQ(p, primary);
+    EXPECT_FALSE(stream.next());
+
+    // Random access works as expected.
+    stream.seek(10);
+    EXPECT_TRUE(stream.next());
+    std::vector<int> exp_i(ref.index.begin() + ref.indptr[10], ref.index.begin() + ref.indptr[11]);
+    EXPECT_EQ(stream.index(), exp_i);
+}
@@ -1,16 +1,12 @@
 #include "tatami_test/test_access.hpp"
 #include "tatami_test/simulate_vector.hpp"
+#include "tatami_test/simulate_compressed_sparse.hpp"
 #include "tatami/tatami.hpp"
 
-static std::vector<double> manual_transpose(size_t NR, size_t NC, const std::vector<double>& contents) {
-    std::vector<double> transposed(NR * NC);
-    for (size_t r = 0; r < NR; ++r) {
-        for (size_t c = 0; c < NC; ++c) {
-            transposed[c * NR + r] = contents[r * NC + c];
-        }
-    }
-    return transposed;
-}
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+#include <limits>
 
 class TestAccessTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
 
@@ -62,6 +58,31 @@ INSTANTIATE_TEST_SUITE_P(
     tatami_test::standard_test_access_options_combinations()
 );
 
+class TestAccessExtendedTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
+
+TEST_P(TestAccessExtendedTest, Parametrized) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+
+    size_t NR = 91, NC = 43;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseMatrix<double, int, decltype(simulated)> mat(NR, NC, simulated, true);
+    auto transposed = manual_transpose(NR, NC, simulated); // Manual transposition for comparison.
+    tatami::DenseMatrix<double, int, decltype(simulated)> ref(NR, NC, transposed, false);
+
+    tatami_test::test_full_access(mat, ref, options);
+    tatami_test::test_block_access(mat, ref, 0.27, 0.6, options);
+    tatami_test::test_indexed_access(mat, ref, 0.3, 0.2, options);
+
+    options.num_threads = 3;
+    tatami_test::test_full_access(mat, ref, options);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TestAccess,
+    TestAccessExtendedTest,
+    tatami_test::extended_test_access_options_combinations()
+);
+
 TEST(TestAccess, Simple) {
     size_t NR = 199, NC = 99;
     auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
@@ -88,6 +109,158 @@ TEST(TestAccess, HandlesNaN) {
     tatami_test::test_simple_column_access(mat, ref);
 }
 
+TEST_P(TestAccessTest, Parallel) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    options.num_threads = 3;
+
+    size_t NR = 101, NC = 77;
+    auto simulated = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseMatrix<double, int, decltype(simulated)> mat(NR, NC, simulated, true);
+    auto transposed = manual_transpose(NR, NC, simulated); // Manual transposition for comparison.
+    tatami::DenseMatrix<double, int, decltype(simulated)> ref(NR, NC, transposed, false);
+
+    tatami_test::test_full_access(mat, ref, options);
+    tatami_test::test_block_access(mat, ref, 0.27, 0.6, options);
+    tatami_test::test_indexed_access(mat, ref, 0.3, 0.2, options);
+
+    // More threads than rows/columns are handled correctly.
+    options.num_threads = 200;
+    tatami_test::test_full_access(mat, ref, options);
+}
+
+TEST_P(TestAccessTest, SparseReference) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    options.sparse_reference = true;
+
+    size_t NR = 87, NC = 123;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, [&]{
+        tatami_test::SimulateCompressedSparseOptions opt;
+        opt.density = 0.1;
+        return opt;
+    }());
+    tatami::CompressedSparseMatrix<double, int, decltype(simulated.data), decltype(simulated.index), decltype(simulated.indptr)> sparse(
+        NR, NC, simulated.data, simulated.index, simulated.indptr, true
+    );
+
+    auto contents = manual_densify(NR, NC, simulated);
+    tatami::DenseMatrix<double, int, decltype(contents)> dense(NR, NC, contents, true);
+
+    // Dense matrices report zeros in their sparse output, which should be ignored in the comparison.
+    tatami_test::test_full_access(dense, sparse, options);
+    tatami_test::test_block_access(dense, sparse, 0.21, 0.5, options);
+    tatami_test::test_indexed_access(dense, sparse, 0.15, 0.3, options);
+
+    tatami_test::test_full_access(sparse, dense, options);
+    tatami_test::test_block_access(sparse, dense, 0.21, 0.5, options);
+    tatami_test::test_indexed_access(sparse, dense, 0.15, 0.3, options);
+}
+
+TEST_P(TestAccessTest, GuardBuffers) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    options.guard_buffers = true;
+
+    size_t NR = 51, NC = 77;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
+    tatami::CompressedSparseMatrix<double, int, decltype(simulated.data), decltype(simulated.index), decltype(simulated.indptr)> sparse(
+        NR, NC, simulated.data, simulated.index, simulated.indptr, true
+    );
+
+    auto contents = manual_densify(NR, NC, simulated);
+    tatami::DenseMatrix<double, int, decltype(contents)> dense(NR, NC, contents, true);
+
+    tatami_test::test_full_access(sparse, dense, options);
+    tatami_test::test_block_access(sparse, dense, 0.1, 0.6, options);
+    tatami_test::test_indexed_access(sparse, dense, 0.2, 0.4, options);
+
+    // Dense matrices might return their own pointers, which is also fine.
+    tatami_test::test_full_access(dense, sparse, options);
+    tatami_test::test_block_access(dense, sparse, 0.1, 0.6, options);
+    tatami_test::test_indexed_access(dense, sparse, 0.2, 0.4, options);
+}
+
+// Dense matrix where the myopic dense extractors write one element outside of the output buffer.
+class OutOfBoundsExtractor final : public tatami::MyopicDenseExtractor<double, int> {
+public:
+    OutOfBoundsExtractor(std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > host, int extent, int offset) :
+        my_host(std::move(host)), my_extent(extent), my_offset(offset) {}
+
+private:
+    std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > my_host;
+    int my_extent, my_offset;
+
+public:
+    const double* fetch(int i, double* buffer) {
+        auto ptr = my_host->fetch(i, buffer);
+        tatami::copy_n(ptr, my_extent, buffer);
+        volatile double* vbuffer = buffer;
+        vbuffer[my_offset] = 1;
+        return buffer;
+    }
+};
+
+class OutOfBoundsMatrix final : public tatami::DenseMatrix<double, int, std::vector<double> > {
+public:
+    OutOfBoundsMatrix(int NR, int NC, std::vector<double> contents, bool after) :
+        tatami::DenseMatrix<double, int, std::vector<double> >(NR, NC, std::move(contents), true), my_after(after) {}
+
+private:
+    bool my_after;
+
+public:
+    using tatami::DenseMatrix<double, int, std::vector<double> >::dense;
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > dense(bool row, const tatami::Options& opt) const {
+        int extent = (row ? this->ncol() : this->nrow());
+        return std::make_unique<OutOfBoundsExtractor>(tatami::DenseMatrix<double, int, std::vector<double> >::dense(row, opt), extent, (my_after ? extent : -1));
+    }
+};
+
+static void test_out_of_bounds(bool after) {
+    int NR = 23, NC = 37;
+    auto contents = tatami_test::simulate_vector<double>(NR * NC, tatami_test::SimulateVectorOptions());
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, contents, true);
+    OutOfBoundsMatrix mat(NR, NC, std::move(contents), after);
+
+    tatami_test::TestAccessOptions options;
+    options.guard_buffers = true;
+    tatami_test::test_full_access(mat, ref, options);
+}
+
+TEST(TestAccess, GuardBuffersUnderrun) {
+    EXPECT_NONFATAL_FAILURE_ON_ALL_THREADS(test_out_of_bounds(false), "writes detected before the start of the output buffers");
+}
+
+TEST(TestAccess, GuardBuffersOverrun) {
+    if (!tatami_test::guard_pages_supported()) {
+        return;
+    }
+
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH(test_out_of_bounds(true), "");
+}
+
+TEST(CompareSparseVectors, Basic) {
+    tatami_test::SparseVector<double, int> expected;
+    expected.index = std::vector<int>{ 1, 5, 10, 20 };
+    expected.value = std::vector<double>{ 1, 2, std::numeric_limits<double>::quiet_NaN(), 4 };
+
+    auto observed = expected;
+    tatami_test::internal::compare_sparse_vectors(expected, observed, "identical", 0);
+
+    // Explicit zeros are ignored.
+    observed.index = std::vector<int>{ 0, 1, 5, 10, 15, 20 };
+    observed.value = std::vector<double>{ 0, 1, 2, std::numeric_limits<double>::quiet_NaN(), 0, 4 };
+    tatami_test::internal::compare_sparse_vectors(expected, observed, "zeros", 0);
+
+    observed.value[4] = 100;
+    observed.value[2] = 100;
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_sparse_vectors(expected, observed, "mismatch", 7), "2 mismatching non-zero(s) for row/column 7 (mismatch)\n  first mismatches at index(es): 5 15");
+
+    observed.index.pop_back();
+    observed.value.pop_back();
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_sparse_vectors(expected, observed, "mismatch", 7), "index(es): 5 15 20");
+}
+
 class SimulateTestAccessSequenceTest : public ::testing::TestWithParam<int> {};
 
 TEST_P(SimulateTestAccessSequenceTest, Forward) {
@@ -126,3 +299,82 @@ INSTANTIATE_TEST_SUITE_P(
     SimulateTestAccessSequenceTest,
     ::testing::Values(1,2,3,4,5,6,7)
 );
+
+TEST(CompareVectors, Basic) {
+    std::vector<double> expected{ 1, 2, std::numeric_limits<double>::quiet_NaN(), 4 };
+    auto observed = expected;
+    tatami_test::internal::compare_vectors(expected, observed, "identical", 0);
+
+    std::vector<int> iexpected{ 1, 2, 3, 4 };
+    tatami_test::internal::compare_vectors(iexpected, iexpected, "integer", 0);
+}
+
+TEST(CompareVectors, Summary) {
+    std::vector<double> expected(10000);
+    std::iota(expected.begin(), expected.end(), 0);
+    auto observed = expected;
+    for (size_t i = 100; i < observed.size(); i += 2) {
+        observed[i] += 0.5;
+    }
+    observed[5000] += 10;
+    observed[3] = std::numeric_limits<double>::quiet_NaN();
+
+    // Only a single failure is reported for the entire vector.
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_vectors(expected, observed, "bulk", 42), "4951 mismatching value(s) out of 10000 for row/column 42 (bulk)");
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_vectors(expected, observed, "bulk", 42), "position(s): 3 (expected 3, observed nan) 100 ");
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_vectors(expected, observed, "bulk", 42), "maximum absolute difference: nan");
+
+    observed[3] = 3;
+    EXPECT_NONFATAL_FAILURE(tatami_test::internal::compare_vectors(expected, observed, "bulk", 42), "maximum absolute difference: 10.5");
+}
+
+TEST(SimulateTestAccessSequence, ExtendedOrders) {
+    // Using a jump of 1 so that all orders start from the same row.
+    tatami_test::TestAccessOptions options;
+    auto forward = tatami_test::internal::simulate_test_access_sequence(49, 20, options);
+    ASSERT_EQ(forward.size(), 49);
+
+    // Chunks of sqrt(49) = 7 in decreasing order, each in increasing order.
+    options.order = tatami_test::TestAccessOrder::CHUNKED;
+    auto chunked = tatami_test::internal::simulate_test_access_sequence(49, 20, options);
+    ASSERT_EQ(chunked.size(), forward.size());
+    EXPECT_EQ(std::vector<int>(chunked.begin(), chunked.begin() + 7), std::vector<int>(forward.end() - 7, forward.end()));
+    size_t restarts = 0;
+    for (size_t i = 1; i < chunked.size(); ++i) {
+        if (chunked[i] < chunked[i - 1]) {
+            ++restarts;
+        } else {
+            EXPECT_EQ(chunked[i] - chunked[i - 1], 1);
+        }
+    }
+    EXPECT_EQ(restarts, 6);
+    std::sort(chunked.begin(), chunked.end());
+    EXPECT_EQ(chunked, forward);
+
+    options.order = tatami_test::TestAccessOrder::ZIGZAG;
+    auto zigzag = tatami_test::internal::simulate_test_access_sequence(49, 20, options);
+    ASSERT_EQ(zigzag.size(), forward.size() * 2);
+    EXPECT_EQ(std::vector<int>(zigzag.begin(), zigzag.begin() + forward.size()), forward);
+    EXPECT_EQ(std::vector<int>(zigzag.rbegin(), zigzag.rbegin() + forward.size()), forward);
+
+    options.order = tatami_test::TestAccessOrder::REPEATED;
+    auto repeated = tatami_test::internal::simulate_test_access_sequence(49, 20, options);
+    EXPECT_GT(repeated.size(), forward.size());
+    EXPECT_LE(repeated.size(), forward.size() * 3);
+    EXPECT_TRUE(std::is_sorted(repeated.begin(), repeated.end()));
+    repeated.erase(std::unique(repeated.begin(), repeated.end()), repeated.end());
+    EXPECT_EQ(repeated, forward);
+
+    // Each chunk of 7 should contain consecutive elements of the forward sequence.
+    options.order = tatami_test::TestAccessOrder::CLUSTERED;
+    auto clustered = tatami_test::internal::simulate_test_access_sequence(49, 20, options);
+    ASSERT_EQ(clustered.size(), forward.size());
+    EXPECT_NE(clustered, forward);
+    for (size_t c = 0; c < clustered.size(); c += 7) {
+        auto mm = std::minmax_element(clustered.begin() + c, clustered.begin() + c + 7);
+        EXPECT_EQ(*(mm.second) - *(mm.first), 6);
+        EXPECT_EQ(*(mm.first) % 7, 0);
+    }
+    std::sort(clustered.begin(), clustered.end());
+    EXPECT_EQ(clustered, forward);
+}
@@ -0,0 +1,48 @@
+#include "tatami_test/test_concurrent_access.hpp"
+#include "tatami_test/simulate_compressed_sparse.hpp"
+#include "tatami/tatami.hpp"
+
+#include "gtest/gtest-spi.h"
+#include "utils.h"
+
+TEST(TestConcurrentAccess, Basic) {
+    int NR = 67, NC = 83;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
+    tatami::CompressedSparseMatrix<double, int, decltype(simulated.data), decltype(simulated.index), decltype(simulated.indptr)> sparse(
+        NR, NC, simulated.data, simulated.index, simulated.indptr, true
+    );
+
+    auto contents = manual_densify(NR, NC, simulated);
+    tatami::DenseMatrix<double, int, decltype(contents)> dense(NR, NC, contents, true);
+
+    tatami_test::TestConcurrentAccessOptions options;
+    options.num_threads = std::vector<int>{ 1, 3, 12 };
+    auto res = tatami_test::test_concurrent_access(sparse, dense, options);
+
+    ASSERT_EQ(res.size(), 3);
+    for (size_t i = 0; i < res.size(); ++i) {
+        EXPECT_EQ(res[i].num_threads, options.num_threads[i]);
+        EXPECT_GE(res[i].checked, res[i].num_threads); // each thread checks at least one row/column.
+        EXPECT_GE(res[i].checked_per_second(), 0);
+    }
+    EXPECT_GT(res[2].checked, res[0].checked);
+}
+
+TEST(TestConcurrentAccess, Mismatch) {
+    int NR = 20, NC = 30;
+    std::vector<double> contents(NR * NC, 1);
+    tatami::DenseMatrix<double, int, decltype(contents)> mat(NR, NC, contents, true);
+    contents[15] = 2;
+    tatami::DenseMatrix<double, int, decltype(contents)> ref(NR, NC, contents, true);
+
+    // Errors in worker threads are still reported.
+    tatami_test::TestConcurrentAccessOptions options;
+    options.num_threads = std::vector<int>{ 2 };
+    ::testing::TestPartResultArray failures;
+    {
+        ::testing::ScopedFakeTestPartResultReporter reporter(::testing::ScopedFakeTestPartResultReporter::INTERCEPT_ALL_THREADS, &failures);
+        tatami_test::test_concurrent_access(mat, ref, options);
+    }
+    ASSERT_GT(failures.size(), 0);
+    EXPECT_TRUE(std::string(failures.GetTestPartResult(0).message()).find("mismatching value(s)") != std::string::npos);
+}
@@ -2,6 +2,10 @@
 #include "tatami_test/simulate_compressed_sparse.hpp"
 #include "tatami/tatami.hpp"
 
+#include "gtest/gtest-spi.h"
+
+#include <algorithm>
+
 class TestUnsortedAccessTest : public ::testing::TestWithParam<tatami_test::StandardTestAccessOptions> {};
 
 TEST_P(TestUnsortedAccessTest, Parametrized) {
@@ -41,6 +45,32 @@ INSTANTIATE_TEST_SUITE_P(
     tatami_test::standard_test_access_options_combinations()
 );
 
+TEST_P(TestUnsortedAccessTest, Parallel) {
+    auto options = tatami_test::convert_test_access_options(GetParam());
+    options.num_threads = 4;
+
+    size_t NR = 87, NC = 123;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NC, NR, tatami_test::SimulateCompressedSparseOptions());
+    tatami::CompressedSparseMatrix<
+        double,
+        int,
+        decltype(simulated.data),
+        decltype(simulated.index),
+        decltype(simulated.indptr)
+    > mat(
+        NR,
+        NC,
+        std::move(simulated.data),
+        std::move(simulated.index),
+        std::move(simulated.indptr),
+        false
+    );
+
+    tatami_test::test_unsorted_full_access(mat, options);
+    tatami_test::test_unsorted_block_access(mat, 0.27, 0.6, options);
+    tatami_test::test_unsorted_indexed_access(mat, 0.3, 0.2, options);
+}
+
 TEST(TestUnsortedAccess, HandlesNaN) {
     size_t NR = 100, NC = 200;
     auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions());
@@ -67,3 +97,136 @@ TEST(TestUnsortedAccess, HandlesNaN) {
     options.use_row = false;
     tatami_test::test_unsorted_full_access(mat, options);
 }
+
+enum class CorruptedIndices : char { DUPLICATED, OUT_OF_RANGE, UNSORTED };
+
+template<bool oracle_>
+class CorruptedIndicesExtractor final : public tatami::SparseExtractor<oracle_, double, int> {
+public:
+    CorruptedIndicesExtractor(std::unique_ptr<tatami::SparseExtractor<oracle_, double, int> > host, CorruptedIndices mode, int extent) :
+        my_host(std::move(host)), my_mode(mode), my_extent(extent) {}
+
+private:
+    std::unique_ptr<tatami::SparseExtractor<oracle_, double, int> > my_host;
+    CorruptedIndices my_mode;
+    int my_extent;
+
+public:
+    tatami::SparseRange<double, int> fetch(int i, double* vbuffer, int* ibuffer) {
+        auto range = my_host->fetch(i, vbuffer, ibuffer);
+        if (range.index && range.number >= 2) {
+            tatami::copy_n(range.index, range.number, ibuffer);
+            range.index = ibuffer;
+            if (my_mode == CorruptedIndices::UNSORTED) {
+                std::reverse(ibuffer, ibuffer + range.number);
+                if (range.value) {
+                    tatami::copy_n(range.value, range.number, vbuffer);
+                    range.value = vbuffer;
+                    std::reverse(vbuffer, vbuffer + range.number);
+                }
+            } else if (my_mode == CorruptedIndices::DUPLICATED) {
+                ibuffer[range.number - 1] = ibuffer[0]; // also means that the last index is missing.
+            } else {
+                ibuffer[range.number - 1] = my_extent + 100;
+            }
+        }
+        return range;
+    }
+};
+
+// Only corrupting the unsorted extractors, so that the sorted output can be used as the reference.
+// The exception is UNSORTED, which reorders the indices from the sorted extractors instead.
+class CorruptedIndicesWrapper final : public tatami::Matrix<double, int> {
+public:
+    CorruptedIndicesWrapper(std::shared_ptr<const tatami::Matrix<double, int> > matrix, CorruptedIndices mode) : my_matrix(std::move(matrix)), my_mode(mode) {}
+
+private:
+    std::shared_ptr<const tatami::Matrix<double, int> > my_matrix;
+    CorruptedIndices my_mode;
+
+    template<bool oracle_>
+    std::unique_ptr<tatami::SparseExtractor<oracle_, double, int> > corrupt(bool row, std::unique_ptr<tatami::SparseExtractor<oracle_, double, int> > host, const tatami::Options& opt) const {
+        if (opt.sparse_ordered_index != (my_mode == CorruptedIndices::UNSORTED)) {
+            return host;
+        }
+        return std::make_unique<CorruptedIndicesExtractor<oracle_> >(std::move(host), my_mode, (row ? my_matrix->ncol() : my_matrix->nrow()));
+    }
+
+public:
+    int nrow() const { return my_matrix->nrow(); }
+    int ncol() const { return my_matrix->ncol(); }
+    bool is_sparse() const { return my_matrix->is_sparse(); }
+    double is_sparse_proportion() const { return my_matrix->is_sparse_proportion(); }
+    bool prefer_rows() const { return my_matrix->prefer_rows(); }
+    double prefer_rows_proportion() const { return my_matrix->prefer_rows_proportion(); }
+    bool uses_oracle(bool row) const { return my_matrix->uses_oracle(row); }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > dense(bool row, const tatami::Options& opt) const {
+        return my_matrix->dense(row, opt);
+    }
+    std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > dense(bool row, int bs, int bl, const tatami::Options& opt) const {
+        return my_matrix->dense(row, bs, bl, opt);
+    }
+    std::unique_ptr<tatami::MyopicDenseExtractor<double, int> > dense(bool row, tatami::VectorPtr<int> idx, const tatami::Options& opt) const {
+        return my_matrix->dense(row, std::move(idx), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<double, int> > sparse(bool row, const tatami::Options& opt) const {
+        return corrupt<false>(row, my_matrix->sparse(row, opt), opt);
+    }
+    std::unique_ptr<tatami::MyopicSparseExtractor<double, int> > sparse(bool row, int bs, int bl, const tatami::Options& opt) const {
+        return corrupt<false>(row, my_matrix->sparse(row, bs, bl, opt), opt);
+    }
+    std::unique_ptr<tatami::MyopicSparseExtractor<double, int> > sparse(bool row, tatami::VectorPtr<int> idx, const tatami::Options& opt) const {
+        return corrupt<false>(row, my_matrix->sparse(row, std::move(idx), opt), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<double, int> > dense(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, const tatami::Options& opt) const {
+        return my_matrix->dense(row, std::move(ora), opt);
+    }
+    std::unique_ptr<tatami::OracularDenseExtractor<double, int> > dense(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, int bs, int bl, const tatami::Options& opt) const {
+        return my_matrix->dense(row, std::move(ora), bs, bl, opt);
+    }
+    std::unique_ptr<tatami::OracularDenseExtractor<double, int> > dense(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, tatami::VectorPtr<int> idx, const tatami::Options& opt) const {
+        return my_matrix->dense(row, std::move(ora), std::move(idx), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<double, int> > sparse(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, const tatami::Options& opt) const {
+        return corrupt<true>(row, my_matrix->sparse(row, std::move(ora), opt), opt);
+    }
+    std::unique_ptr<tatami::OracularSparseExtractor<double, int> > sparse(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, int bs, int bl, const tatami::Options& opt) const {
+        return corrupt<true>(row, my_matrix->sparse(row, std::move(ora), bs, bl, opt), opt);
+    }
+    std::unique_ptr<tatami::OracularSparseExtractor<double, int> > sparse(bool row, std::shared_ptr<const tatami::Oracle<int> > ora, tatami::VectorPtr<int> idx, const tatami::Options& opt) const {
+        return corrupt<true>(row, my_matrix->sparse(row, std::move(ora), std::move(idx), opt), opt);
+    }
+};
+
+static void test_corrupted_indices(CorruptedIndices mode, bool use_oracle) {
+    size_t NR = 50, NC = 80;
+    tatami_test::SimulateCompressedSparseOptions sopt;
+    sopt.density = 0.3;
+    auto simulated = tatami_test::simulate_compressed_sparse<double, int>(NR, NC, sopt);
+    auto mat = std::make_shared<tatami::CompressedSparseMatrix<double, int, decltype(simulated.data), decltype(simulated.index), decltype(simulated.indptr)> >(
+        NR,
+        NC,
+        std::move(simulated.data),
+        std::move(simulated.index),
+        std::move(simulated.indptr),
+        true
+    );
+
+    CorruptedIndicesWrapper wrapped(std::move(mat), mode);
+    tatami_test::TestAccessOptions options;
+    options.use_oracle = use_oracle;
+    tatami_test::test_unsorted_full_access(wrapped, options);
+}
+
+TEST(TestUnsortedAccess, BadIndices) {
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::DUPLICATED, false), "not a permutation of the sorted indices");
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::DUPLICATED, true), "not a permutation of the sorted indices");
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::OUT_OF_RANGE, false), "out of range");
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::OUT_OF_RANGE, true), "out of range");
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::UNSORTED, false), "not strictly increasing");
+    EXPECT_FATAL_FAILURE_ON_ALL_THREADS(test_corrupted_indices(CorruptedIndices::UNSORTED, true), "not strictly increasing");
+}
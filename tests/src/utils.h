@@ -0,0 +1,49 @@
+#ifndef UTILS_H
+#define UTILS_H
+
+#include "tatami_test/simulate_compressed_sparse.hpp"
+#include "tatami/tatami.hpp"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Manual transposition of a row-major array, for creating column-major references.
+inline std::vector<double> manual_transpose(size_t NR, size_t NC, const std::vector<double>& contents) {
+    std::vector<double> transposed(NR * NC);
+    for (size_t r = 0; r < NR; ++r) {
+        for (size_t c = 0; c < NC; ++c) {
+            transposed[c * NR + r] = contents[r * NC + c];
+        }
+    }
+    return transposed;
+}
+
+// Expanding a simulated compressed sparse row matrix into a row-major array, for creating dense references.
+inline std::vector<double> manual_densify(size_t NR, size_t NC, const tatami_test::SimulateCompressedSparseResult<double, int>& simulated) {
+    std::vector<double> contents(NR * NC);
+    for (size_t r = 0; r < NR; ++r) {
+        for (size_t k = simulated.indptr[r], end = simulated.indptr[r + 1]; k < end; ++k) {
+            contents[r * NC + simulated.index[k]] = simulated.data[k];
+        }
+    }
+    return contents;
+}
+
+// Wrapping a simulated compressed sparse row matrix in a row-major tatami::CompressedSparseMatrix.
+inline std::shared_ptr<tatami::Matrix<double, int> > create_sparse_matrix(int NR, int NC, tatami_test::SimulateCompressedSparseResult<double, int> simulated) {
+    return std::make_shared<tatami::CompressedSparseMatrix<double, int, decltype(simulated.data), decltype(simulated.index), decltype(simulated.indptr)> >(
+        NR,
+        NC,
+        std::move(simulated.data),
+        std::move(simulated.index),
+        std::move(simulated.indptr),
+        true
+    );
+}
+
+inline std::shared_ptr<tatami::Matrix<double, int> > simulate_sparse_matrix(int NR, int NC) {
+    return create_sparse_matrix(NR, NC, tatami_test::simulate_compressed_sparse<double, int>(NR, NC, tatami_test::SimulateCompressedSparseOptions()));
+}
+
+#endif